@@ -0,0 +1,230 @@
+#include "Batch.hh"
+
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "Expression.hh"
+#include "Profiler.hh"
+#include "Factorization.hh"
+#include "Integer.hh"
+#include "ResultCache.hh"
+
+namespace {
+
+constexpr size_t bufferSize = 1 << 20;
+
+size_t tokenize(std::string_view line,
+                std::array<std::string_view, 4> &tokens) {
+  size_t count = 0, position = 0;
+  while (position < line.size()) {
+    while (position < line.size() &&
+           (line[position] == ' ' || line[position] == '\t' ||
+            line[position] == '\r'))
+      ++position;
+    if (position == line.size())
+      break;
+    if (count == tokens.size())
+      throw std::invalid_argument("Too many tokens");
+    size_t end = position;
+    while (end < line.size() && line[end] != ' ' && line[end] != '\t' &&
+           line[end] != '\r')
+      ++end;
+    tokens[count++] = line.substr(position, end - position);
+    position = end;
+  }
+  return count;
+}
+
+Integer operand(std::string_view token) {
+  if (!token.empty() && token[0] == '@')
+    return Integer::load(std::string(token.substr(1)));
+  return Integer(token);
+}
+
+Integer evaluate(const std::array<std::string_view, 4> &tokens, size_t count) {
+  auto expect = [count](size_t arguments) {
+    if (count != arguments + 1)
+      throw std::invalid_argument("Wrong number of arguments");
+  };
+  ResultCache &cache = ResultCache::instance();
+  std::string_view name = tokens[0];
+  if (count == 3 && tokens[1].size() == 1 &&
+      std::string_view("+-*/%^").find(tokens[1][0]) != std::string_view::npos) {
+    Integer first = operand(tokens[0]), second = operand(tokens[2]);
+    switch (tokens[1][0]) {
+    case '+':
+      return first + second;
+    case '-':
+      return first - second;
+    case '*':
+      return cache.get(
+          Operation::Multiply, [&] { return first * second; }, first, second);
+    case '/':
+      return cache.get(
+          Operation::Divide, [&] { return first / second; }, first, second);
+    case '%':
+      return cache.get(
+          Operation::Modulo, [&] { return first % second; }, first, second);
+    case '^':
+      return cache.get(
+          Operation::Power, [&] { return power(first, second); }, first,
+          second);
+    }
+  }
+  if (name == "gcd") {
+    expect(2);
+    Integer first = operand(tokens[1]), second = operand(tokens[2]);
+    return cache.get(
+        Operation::Gcd, [&] { return gcd(first, second); }, first, second);
+  }
+  if (name == "lcm") {
+    expect(2);
+    Integer first = operand(tokens[1]), second = operand(tokens[2]);
+    return cache.get(
+        Operation::Lcm, [&] { return lcm(first, second); }, first, second);
+  }
+  if (name == "powmod") {
+    expect(3);
+    Integer base = operand(tokens[1]), exponent = operand(tokens[2]),
+            modulus = operand(tokens[3]);
+    return cache.get(
+        Operation::PowerModulo,
+        [&] { return powMod(base, exponent, modulus); }, base, exponent,
+        modulus);
+  }
+  if (name == "modinv") {
+    expect(2);
+    Integer value = operand(tokens[1]), modulus = operand(tokens[2]);
+    return cache.get(
+        Operation::ModularInverse, [&] { return modInverse(value, modulus); },
+        value, modulus);
+  }
+  if (name == "factorial") {
+    expect(1);
+    Integer number = operand(tokens[1]);
+    return cache.get(
+        Operation::Factorial, [&] { return factorial(number); }, number);
+  }
+  if (name == "isqrt") {
+    expect(1);
+    Integer number = operand(tokens[1]);
+    return cache.get(
+        Operation::SquareRoot, [&] { return isqrt(number); }, number);
+  }
+  if (name == "iroot") {
+    expect(2);
+    Integer number = operand(tokens[1]), degree = operand(tokens[2]);
+    return cache.get(
+        Operation::Root, [&] { return iroot(number, degree); }, number,
+        degree);
+  }
+  if (name == "perfectpower") {
+    expect(1);
+    Integer number = operand(tokens[1]);
+    return cache.get(
+        Operation::PerfectPower,
+        [&] { return Integer(isPerfectPower(number) ? 1LL : 0LL); }, number);
+  }
+  if (name == "prime") {
+    expect(1);
+    Integer number = operand(tokens[1]);
+    return cache.get(
+        Operation::Prime, [&] { return Integer(isPrime(number) ? 1LL : 0LL); },
+        number);
+  }
+  throw std::invalid_argument("Unknown operation");
+}
+
+std::string factor(const std::array<std::string_view, 4> &tokens,
+                   size_t count) {
+  if (count != 2 && count != 3)
+    throw std::invalid_argument("Wrong number of arguments");
+  std::uint32_t seconds = 0;
+  if (count == 3) {
+    const char *end = tokens[2].data() + tokens[2].size();
+    auto [last, error] = std::from_chars(tokens[2].data(), end, seconds);
+    if (error != std::errc() || last != end)
+      throw std::invalid_argument("Invalid time budget");
+  }
+  std::chrono::seconds budget(seconds);
+  return factorize(operand(tokens[1]), nullptr, budget).toString();
+}
+
+} // namespace
+
+int runBatch(std::istream &input, std::FILE *output) {
+  std::string line, result;
+  std::array<std::string_view, 4> tokens;
+  int status = 0;
+  while (std::getline(input, line)) {
+    size_t count = 0;
+    PROFILE_SCOPE("batch.line", line.size());
+    try {
+      std::string_view text(line);
+      size_t start = text.find_first_not_of(" \t\r");
+      if (start == std::string_view::npos || text[start] == '#')
+        continue;
+      text.remove_prefix(start);
+      std::string target;
+      size_t arrow = text.rfind(" > ");
+      if (arrow != std::string_view::npos) {
+        std::array<std::string_view, 4> path;
+        if (tokenize(text.substr(arrow + 3), path) != 1)
+          throw std::invalid_argument("Expected one file after '>'");
+        target = path[0];
+        text = text.substr(0, arrow);
+      }
+      bool expression = text.substr(0, 5) == "eval ";
+      if (!expression)
+        count = tokenize(text, tokens);
+      if (!expression && tokens[0] == "factor") {
+        if (!target.empty())
+          throw std::invalid_argument("Factorization cannot be saved");
+        result = factor(tokens, count);
+      } else {
+        Integer value = expression ? Expression(text.substr(5)).evaluate()
+                                   : evaluate(tokens, count);
+        if (target.empty()) {
+          value.toString(result);
+        } else {
+          value.save(target);
+          result = target;
+        }
+      }
+    } catch (const std::exception &exception) {
+      result = "error: ";
+      result += exception.what();
+      status = 1;
+    }
+    result += '\n';
+    std::fwrite(result.data(), 1, result.size(), output);
+  }
+  std::fflush(output);
+  return status;
+}
+
+int runBatch(const std::string &path) {
+  static std::vector<char> outputBuffer(bufferSize);
+  std::setvbuf(stdout, outputBuffer.data(), _IOFBF, outputBuffer.size());
+  if (path == "-") {
+    std::ios::sync_with_stdio(false);
+    return runBatch(std::cin, stdout);
+  }
+  auto inputBuffer = std::make_unique<char[]>(bufferSize);
+  std::ifstream input;
+  input.rdbuf()->pubsetbuf(inputBuffer.get(), bufferSize);
+  input.open(path, std::ios::binary);
+  if (!input) {
+    std::fprintf(stderr, "Cannot open %s\n", path.c_str());
+    return 2;
+  }
+  return runBatch(input, stdout);
+}
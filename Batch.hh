@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstdio>
+#include <istream>
+#include <string>
+
+int runBatch(std::istream &input, std::FILE *output);
+int runBatch(const std::string &path);
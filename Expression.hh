@@ -0,0 +1,436 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Integer.hh"
+
+class Expression {
+public:
+  using Variables = std::map<std::string, Integer, std::less<>>;
+
+  explicit Expression(std::string_view text) {
+    Parser parser(text);
+    std::unordered_map<const Syntax *, size_t> lowered;
+    root = lower(*parser.parseProgram(), lowered);
+    schedule();
+  }
+
+  Integer evaluate(const Variables &variables = Variables()) const {
+    std::vector<Integer> values(nodes.size());
+    for (size_t level = 0; level < levels.size(); ++level) {
+      const std::vector<size_t> &batch = levels[level];
+      Integer::parallelFor(batch.size(), level > 0, [&](size_t position) {
+        size_t id = batch[position];
+        values[id] = compute(nodes[id], values, variables);
+      });
+      for (size_t id : releases[level])
+        values[id] = Integer();
+    }
+    return std::move(values[root]);
+  }
+
+  size_t nodeCount() const { return order.size(); }
+
+private:
+  enum class Kind {
+    Constant,
+    Variable,
+    Negate,
+    Absolute,
+    Add,
+    Subtract,
+    Multiply,
+    Square,
+    Divide,
+    Modulo,
+    Power,
+    PowerModulo,
+    PowerRemainder,
+    ModularInverse,
+    Factorial,
+    SquareRoot,
+    Root,
+    Gcd,
+    Lcm,
+    Prime
+  };
+
+  struct Syntax {
+    Kind kind;
+    std::string text;
+    std::vector<std::shared_ptr<const Syntax>> children;
+  };
+
+  using Tree = std::shared_ptr<const Syntax>;
+
+  struct Function {
+    std::string_view name;
+    Kind kind;
+    size_t arity;
+  };
+
+  static constexpr Function functions[] = {
+      {"abs", Kind::Absolute, 1},
+      {"gcd", Kind::Gcd, 2},
+      {"lcm", Kind::Lcm, 2},
+      {"powmod", Kind::PowerModulo, 3},
+      {"modinv", Kind::ModularInverse, 2},
+      {"factorial", Kind::Factorial, 1},
+      {"isqrt", Kind::SquareRoot, 1},
+      {"iroot", Kind::Root, 2},
+      {"prime", Kind::Prime, 1}};
+
+  class Parser {
+  public:
+    explicit Parser(std::string_view source) : text(source), position(0) {}
+
+    Tree parseProgram() {
+      Tree result;
+      do {
+        skipSpace();
+        if (position == text.size())
+          break;
+        result = parseStatement();
+      } while (accept(';'));
+      skipSpace();
+      if (position != text.size())
+        throw std::invalid_argument("Unexpected character in expression");
+      if (!result)
+        throw std::invalid_argument("Empty expression");
+      return result;
+    }
+
+  private:
+    Tree parseStatement() {
+      size_t start = position;
+      std::string name = identifier();
+      if (!name.empty() && accept('=')) {
+        Tree value = parseSum();
+        definitions[name] = value;
+        return value;
+      }
+      position = start;
+      return parseSum();
+    }
+
+    Tree parseSum() {
+      Tree left = parseProduct();
+      for (;;) {
+        if (accept('+'))
+          left = make(Kind::Add, {left, parseProduct()});
+        else if (accept('-'))
+          left = make(Kind::Subtract, {left, parseProduct()});
+        else
+          return left;
+      }
+    }
+
+    Tree parseProduct() {
+      Tree left = parseUnary();
+      for (;;) {
+        if (accept('*'))
+          left = make(Kind::Multiply, {left, parseUnary()});
+        else if (accept('/'))
+          left = make(Kind::Divide, {left, parseUnary()});
+        else if (accept('%'))
+          left = make(Kind::Modulo, {left, parseUnary()});
+        else
+          return left;
+      }
+    }
+
+    Tree parseUnary() {
+      if (accept('-'))
+        return make(Kind::Negate, {parseUnary()});
+      if (accept('+'))
+        return parseUnary();
+      Tree base = parsePostfix();
+      if (accept('^'))
+        return make(Kind::Power, {base, parseUnary()});
+      return base;
+    }
+
+    Tree parsePostfix() {
+      Tree value = parsePrimary();
+      while (accept('!'))
+        value = make(Kind::Factorial, {value});
+      return value;
+    }
+
+    Tree parsePrimary() {
+      skipSpace();
+      if (accept('(')) {
+        Tree value = parseSum();
+        expect(')');
+        return value;
+      }
+      if (accept('@')) {
+        size_t start = position;
+        while (position < text.size() && !isSpace(text[position]) &&
+               std::string_view(",;()").find(text[position]) ==
+                   std::string_view::npos)
+          ++position;
+        if (position == start)
+          throw std::invalid_argument("Expected file name after '@'");
+        std::string file(text.substr(start - 1, position - start + 1));
+        return std::make_shared<const Syntax>(
+            Syntax{Kind::Constant, std::move(file), {}});
+      }
+      if (position < text.size() && isDigit(text[position])) {
+        size_t start = position;
+        while (position < text.size() && isDigit(text[position]))
+          ++position;
+        return std::make_shared<const Syntax>(Syntax{
+            Kind::Constant, std::string(text.substr(start, position - start)),
+            {}});
+      }
+      std::string name = identifier();
+      if (name.empty())
+        throw std::invalid_argument("Unexpected character in expression");
+      if (!accept('(')) {
+        auto definition = definitions.find(name);
+        if (definition != definitions.end())
+          return definition->second;
+        return std::make_shared<const Syntax>(
+            Syntax{Kind::Variable, std::move(name), {}});
+      }
+      const Function *function = nullptr;
+      for (const Function &candidate : functions)
+        if (candidate.name == name)
+          function = &candidate;
+      if (!function)
+        throw std::invalid_argument("Unknown function " + name);
+      std::vector<Tree> arguments;
+      if (!accept(')')) {
+        do
+          arguments.push_back(parseSum());
+        while (accept(','));
+        expect(')');
+      }
+      if (arguments.size() != function->arity)
+        throw std::invalid_argument("Wrong number of arguments to " + name);
+      return make(function->kind, std::move(arguments));
+    }
+
+    static bool isDigit(char character) {
+      return character >= '0' && character <= '9';
+    }
+
+    static bool isSpace(char character) {
+      return character == ' ' || character == '\t' || character == '\r' ||
+             character == '\n';
+    }
+
+    static bool isLetter(char character) {
+      return (character >= 'a' && character <= 'z') ||
+             (character >= 'A' && character <= 'Z') || character == '_';
+    }
+
+    static Tree make(Kind kind, std::vector<Tree> children) {
+      return std::make_shared<const Syntax>(
+          Syntax{kind, std::string(), std::move(children)});
+    }
+
+    std::string identifier() {
+      skipSpace();
+      size_t start = position;
+      if (position < text.size() && isLetter(text[position]))
+        while (position < text.size() &&
+               (isLetter(text[position]) || isDigit(text[position])))
+          ++position;
+      return std::string(text.substr(start, position - start));
+    }
+
+    void skipSpace() {
+      while (position < text.size() && isSpace(text[position]))
+        ++position;
+    }
+
+    bool accept(char symbol) {
+      skipSpace();
+      if (position == text.size() || text[position] != symbol)
+        return false;
+      ++position;
+      return true;
+    }
+
+    void expect(char symbol) {
+      if (!accept(symbol))
+        throw std::invalid_argument(std::string("Expected '") + symbol +
+                                    "' in expression");
+    }
+
+    std::string_view text;
+    size_t position;
+    std::map<std::string, Tree, std::less<>> definitions;
+  };
+
+  struct Node {
+    Kind kind;
+    std::vector<size_t> inputs;
+    std::string name;
+    Integer value;
+  };
+
+  using Key = std::tuple<Kind, std::vector<size_t>, std::string>;
+
+  static bool isCommutative(Kind kind) {
+    return kind == Kind::Add || kind == Kind::Multiply || kind == Kind::Gcd ||
+           kind == Kind::Lcm;
+  }
+
+  size_t intern(Kind kind, std::vector<size_t> inputs, std::string name) {
+    if (isCommutative(kind))
+      std::sort(inputs.begin(), inputs.end());
+    if (kind == Kind::Multiply && inputs[0] == inputs[1]) {
+      kind = Kind::Square;
+      inputs.pop_back();
+    }
+    Key key(kind, inputs, name);
+    auto found = index.find(key);
+    if (found != index.end())
+      return found->second;
+    Node node{kind, std::move(inputs), std::move(name), Integer()};
+    if (kind == Kind::Constant)
+      node.value = node.name[0] == '@' ? Integer::load(node.name.substr(1))
+                                       : Integer(node.name);
+    nodes.push_back(std::move(node));
+    index.emplace(std::move(key), nodes.size() - 1);
+    return nodes.size() - 1;
+  }
+
+  size_t lower(const Syntax &syntax,
+               std::unordered_map<const Syntax *, size_t> &lowered) {
+    auto found = lowered.find(&syntax);
+    if (found != lowered.end())
+      return found->second;
+    Integer::checkCancellation();
+    size_t id;
+    if (syntax.kind == Kind::Constant) {
+      size_t digits = syntax.text[0] == '@'
+                          ? 0
+                          : std::min(syntax.text.find_first_not_of('0'),
+                                     syntax.text.size() - 1);
+      id = intern(Kind::Constant, {}, syntax.text.substr(digits));
+    } else if (syntax.kind == Kind::Variable) {
+      id = intern(Kind::Variable, {}, syntax.text);
+    } else if (syntax.kind == Kind::Modulo &&
+               syntax.children[0]->kind == Kind::Power) {
+      const Syntax &power = *syntax.children[0];
+      id = intern(Kind::PowerRemainder,
+                  {lower(*power.children[0], lowered),
+                   lower(*power.children[1], lowered),
+                   lower(*syntax.children[1], lowered)},
+                  std::string());
+    } else {
+      std::vector<size_t> inputs;
+      for (const Tree &child : syntax.children)
+        inputs.push_back(lower(*child, lowered));
+      id = intern(syntax.kind, std::move(inputs), std::string());
+    }
+    lowered.emplace(&syntax, id);
+    return id;
+  }
+
+  void schedule() {
+    std::vector<bool> reachable(nodes.size());
+    reachable[root] = true;
+    for (size_t id = nodes.size(); id-- > 0;)
+      if (reachable[id])
+        for (size_t input : nodes[id].inputs)
+          reachable[input] = true;
+    std::vector<size_t> level(nodes.size()), lastUse(nodes.size());
+    for (size_t id = 0; id < nodes.size(); ++id) {
+      if (!reachable[id])
+        continue;
+      order.push_back(id);
+      for (size_t input : nodes[id].inputs)
+        level[id] = std::max(level[id], level[input] + 1);
+      for (size_t input : nodes[id].inputs)
+        lastUse[input] = std::max(lastUse[input], level[id]);
+      if (levels.size() <= level[id])
+        levels.resize(level[id] + 1);
+      levels[level[id]].push_back(id);
+    }
+    releases.resize(levels.size());
+    for (size_t id : order)
+      if (id != root)
+        releases[lastUse[id]].push_back(id);
+  }
+
+  static Integer compute(const Node &node, const std::vector<Integer> &values,
+                         const Variables &variables) {
+    auto input = [&](size_t position) -> const Integer & {
+      return values[node.inputs[position]];
+    };
+    switch (node.kind) {
+    case Kind::Constant:
+      return node.value;
+    case Kind::Variable: {
+      auto found = variables.find(node.name);
+      if (found == variables.end())
+        throw std::invalid_argument("Undefined variable " + node.name);
+      return found->second;
+    }
+    case Kind::Negate:
+      return -input(0);
+    case Kind::Absolute:
+      return input(0).absolute();
+    case Kind::Add:
+      return input(0) + input(1);
+    case Kind::Subtract:
+      return input(0) - input(1);
+    case Kind::Multiply:
+      return input(0) * input(1);
+    case Kind::Square:
+      return square(input(0));
+    case Kind::Divide:
+      return input(0) / input(1);
+    case Kind::Modulo:
+      return input(0) % input(1);
+    case Kind::Power:
+      return power(input(0), input(1));
+    case Kind::PowerModulo:
+      return powMod(input(0), input(1), input(2));
+    case Kind::PowerRemainder: {
+      if (input(1).isNegative())
+        throw std::domain_error("Negative exponent");
+      Integer result = powMod(input(0), input(1), input(2));
+      if (input(0).isNegative() && input(1).testBit(0) && !result.isZero())
+        result -= input(2).absolute();
+      return result;
+    }
+    case Kind::ModularInverse:
+      return modInverse(input(0), input(1));
+    case Kind::Factorial:
+      return factorial(input(0));
+    case Kind::SquareRoot:
+      return isqrt(input(0));
+    case Kind::Root:
+      return iroot(input(0), input(1));
+    case Kind::Gcd:
+      return gcd(input(0), input(1));
+    case Kind::Lcm:
+      return lcm(input(0), input(1));
+    case Kind::Prime:
+      return Integer(isPrime(input(0)) ? 1LL : 0LL);
+    }
+    return Integer();
+  }
+
+  std::vector<Node> nodes;
+  std::map<Key, size_t> index;
+  size_t root;
+  std::vector<size_t> order;
+  std::vector<std::vector<size_t>> levels;
+  std::vector<std::vector<size_t>> releases;
+};
@@ -0,0 +1,526 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Integer.hh"
+
+struct Factorization {
+  bool negative = false;
+  std::vector<std::pair<Integer, size_t>> primes;
+  std::vector<std::pair<Integer, size_t>> composites;
+
+  bool isComplete() const { return composites.empty(); }
+
+  std::string toString() const {
+    std::string text = negative ? "-1" : "";
+    auto append = [&text](const Integer &factor, size_t exponent,
+                          bool composite) {
+      if (!text.empty())
+        text += " * ";
+      text += composite ? "[" + factor.toString() + "]" : factor.toString();
+      if (exponent > 1)
+        text += "^" + std::to_string(exponent);
+    };
+    for (const auto &[prime, exponent] : primes)
+      append(prime, exponent, false);
+    for (const auto &[composite, exponent] : composites)
+      append(composite, exponent, true);
+    return text.empty() ? "1" : text;
+  }
+};
+
+class PrimeSieve {
+public:
+  explicit PrimeSieve(std::uint64_t bound)
+      : limit(bound), low(3), position(0), emittedTwo(false) {
+    std::uint64_t root = 1;
+    while ((root + 1) * (root + 1) <= limit)
+      ++root;
+    if (root < smallPrimeLimit) {
+      for (unsigned prime : smallPrimes)
+        if (prime > 2 && prime <= root)
+          basePrimes.push_back(prime);
+      return;
+    }
+    std::vector<bool> composite(root + 1, false);
+    for (std::uint64_t candidate = 3; candidate <= root; candidate += 2) {
+      if (composite[candidate])
+        continue;
+      basePrimes.push_back(candidate);
+      for (std::uint64_t multiple = candidate * candidate; multiple <= root;
+           multiple += 2 * candidate)
+        composite[multiple] = true;
+    }
+  }
+
+  std::uint64_t next() {
+    if (!emittedTwo) {
+      emittedTwo = true;
+      return limit >= 2 ? 2 : 0;
+    }
+    for (;;) {
+      while (position < segment.size())
+        if (!segment[position++]) {
+          std::uint64_t prime = low + 2 * (position - 1);
+          return prime <= limit ? prime : 0;
+        }
+      if (!segment.empty())
+        low += 2 * segment.size();
+      if (low > limit)
+        return 0;
+      sieveSegment();
+    }
+  }
+
+private:
+  static constexpr size_t segmentSize = 1 << 15;
+
+  void sieveSegment() {
+    segment.assign(segmentSize, 0);
+    position = 0;
+    std::uint64_t high = low + 2 * segmentSize;
+    for (std::uint64_t prime : basePrimes) {
+      if (prime * prime >= high)
+        break;
+      std::uint64_t start =
+          std::max(prime * prime, (low + prime - 1) / prime * prime);
+      if (start % 2 == 0)
+        start += prime;
+      for (std::uint64_t multiple = start; multiple < high;
+           multiple += 2 * prime)
+        segment[(multiple - low) / 2] = 1;
+    }
+  }
+
+  std::uint64_t limit;
+  std::uint64_t low;
+  size_t position;
+  bool emittedTwo;
+  std::vector<std::uint64_t> basePrimes;
+  std::vector<char> segment;
+};
+
+class Factorizer {
+public:
+  using Clock = std::chrono::steady_clock;
+  using Callback = std::function<void(const Integer &, size_t)>;
+
+  static inline std::uint64_t trialDivisionLimit = 1 << 20;
+  static inline size_t rhoIterations = 1 << 16;
+
+  static Factorization factorize(const Integer &number,
+                                 const Callback &onFactor,
+                                 Clock::duration budget) {
+    if (number.isZero())
+      throw std::domain_error("Factorization of zero");
+    Factorizer factorizer(onFactor, budget);
+    factorizer.result.negative = number.isNegative();
+    Integer rest = factorizer.trialDivide(number.absolute());
+    if (rest != Integer(1LL))
+      factorizer.pending.push_back({std::move(rest), 1});
+    while (!factorizer.pending.empty()) {
+      Integer::checkCancellation();
+      auto [value, multiplicity] = std::move(factorizer.pending.back());
+      factorizer.pending.pop_back();
+      if (isPrime(value)) {
+        factorizer.report(value, multiplicity);
+        continue;
+      }
+      if (factorizer.expired()) {
+        factorizer.result.composites.push_back({value, multiplicity});
+        continue;
+      }
+      auto [root, degree] = perfectPower(value);
+      if (degree > 1) {
+        factorizer.pending.push_back({std::move(root), multiplicity * degree});
+        continue;
+      }
+      Integer divisor = factorizer.findDivisor(value);
+      if (divisor.isZero()) {
+        factorizer.result.composites.push_back({value, multiplicity});
+        continue;
+      }
+      factorizer.pending.push_back({value / divisor, multiplicity});
+      factorizer.pending.push_back({std::move(divisor), multiplicity});
+    }
+    merge(factorizer.result.primes);
+    merge(factorizer.result.composites);
+    return std::move(factorizer.result);
+  }
+
+private:
+  using Limb = Integer::Limb;
+  using DoubleLimb = Integer::DoubleLimb;
+
+  struct Point {
+    Integer x;
+    Integer z;
+  };
+
+  struct Search {
+    std::atomic<bool> done{false};
+    std::mutex mutex;
+    Integer divisor;
+
+    void offer(const Integer &found) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!done) {
+        divisor = found;
+        done = true;
+      }
+    }
+  };
+
+  struct CurveBound {
+    std::uint64_t stageOne;
+    size_t curves;
+  };
+
+  static constexpr std::array<CurveBound, 8> curveBounds{{{2000, 25},
+                                                          {11000, 90},
+                                                          {50000, 300},
+                                                          {250000, 700},
+                                                          {1000000, 1800},
+                                                          {3000000, 5100},
+                                                          {11000000, 10600},
+                                                          {43000000, 19300}}};
+  static constexpr std::uint64_t stageTwoFactor = 50;
+  static constexpr std::uint64_t giantStep = 210;
+
+  Factorizer(const Callback &callback, Clock::duration budget)
+      : onFactor(callback),
+        deadline(budget > Clock::duration::zero() ? Clock::now() + budget
+                                                  : Clock::time_point::max()) {
+  }
+
+  static void merge(std::vector<std::pair<Integer, size_t>> &factors) {
+    std::sort(factors.begin(), factors.end(),
+              [](const auto &first, const auto &second) {
+                return first.first < second.first;
+              });
+    size_t count = 0;
+    for (size_t index = 0; index < factors.size(); ++index) {
+      if (count > 0 && factors[count - 1].first == factors[index].first)
+        factors[count - 1].second += factors[index].second;
+      else
+        factors[count++] = std::move(factors[index]);
+    }
+    factors.resize(count);
+  }
+
+  void report(const Integer &prime, size_t exponent) {
+    result.primes.push_back({prime, exponent});
+    if (onFactor)
+      onFactor(prime, exponent);
+  }
+
+  bool expired() const { return Clock::now() >= deadline; }
+
+  bool stopped(Search &search) const {
+    Integer::checkCancellation();
+    if (expired())
+      search.done = true;
+    return search.done;
+  }
+
+  Integer trialDivide(Integer value) {
+    PrimeSieve sieve(std::max<std::uint64_t>(trialDivisionLimit, 2));
+    std::array<Limb, 16> batch;
+    for (Limb prime = sieve.next(); prime;) {
+      Integer::checkCancellation();
+      if (value.limbs.size() == 1 && prime * prime > value.limbs[0])
+        break;
+      Limb product = 1;
+      size_t count = 0;
+      while (prime && count < batch.size() && product <= ~Limb(0) / prime) {
+        product *= prime;
+        batch[count++] = prime;
+        prime = sieve.next();
+      }
+      Limb residue = value.moduloLimb(product);
+      for (size_t index = 0; index < count; ++index) {
+        if (residue % batch[index] != 0)
+          continue;
+        size_t exponent = 0;
+        while (value.moduloLimb(batch[index]) == 0) {
+          value.divideByLimb(batch[index]);
+          ++exponent;
+        }
+        report(Integer::fromLimbs(&batch[index], 1), exponent);
+      }
+    }
+    return value;
+  }
+
+  static std::pair<Integer, size_t> perfectPower(const Integer &value) {
+    if (!value.testBit(0))
+      return {value, 1};
+    PrimeSieve sieve(value.bitLength());
+    for (std::uint64_t degree = sieve.next(); degree; degree = sieve.next())
+      if (Integer::hasRoot(value, degree))
+        return {Integer::root(value, degree), degree};
+    return {value, 1};
+  }
+
+  Integer findDivisor(const Integer &value) {
+    if (!value.testBit(0))
+      return Integer(2LL);
+    Search search;
+    if (value.limbs.size() == 1) {
+      for (Limb increment = 1; !stopped(search); ++increment)
+        if (Limb divisor = rhoLimb(value.limbs[0], increment))
+          return Integer::fromLimbs(&divisor, 1);
+      return Integer();
+    }
+    Modulus context(value);
+    size_t workers = Integer::threadCount();
+    Integer::parallelFor(workers, workers > 1, [&](size_t worker) {
+      if (rho(context, worker + 1, search))
+        return;
+      for (size_t curve = worker; !stopped(search); curve += workers)
+        if (ecm(context, curve, search))
+          return;
+    });
+    return search.divisor;
+  }
+
+  Limb rhoLimb(Limb value, Limb increment) const {
+    auto step = [value, increment](Limb current) {
+      return static_cast<Limb>(
+          (static_cast<DoubleLimb>(current) * current + increment) % value);
+    };
+    Limb fast = 2, slow = 2, saved = 2, accumulated = 1, divisor = 1;
+    for (size_t range = 1; divisor == 1; range *= 2) {
+      slow = fast;
+      for (size_t index = 0; index < range; ++index)
+        fast = step(fast);
+      for (size_t done = 0; done < range && divisor == 1; done += 128) {
+        Integer::checkCancellation();
+        saved = fast;
+        for (size_t index = 0; index < std::min<size_t>(128, range - done);
+             ++index) {
+          fast = step(fast);
+          Limb difference = slow > fast ? slow - fast : fast - slow;
+          accumulated = static_cast<Limb>(
+              static_cast<DoubleLimb>(accumulated) * difference % value);
+        }
+        divisor = std::gcd(accumulated, value);
+      }
+    }
+    if (divisor == value)
+      do {
+        saved = step(saved);
+        divisor = std::gcd(slow > saved ? slow - saved : saved - slow, value);
+      } while (divisor == 1);
+    return divisor == value ? 0 : divisor;
+  }
+
+  static Integer subtract(const Integer &first, const Integer &second,
+                          const Integer &modulus) {
+    Integer difference = first - second;
+    if (difference.isNegative())
+      difference += modulus;
+    return difference;
+  }
+
+  static Integer add(const Integer &first, const Integer &second,
+                     const Integer &modulus) {
+    Integer sum = first + second;
+    if (sum >= modulus)
+      sum -= modulus;
+    return sum;
+  }
+
+  bool rho(const Modulus &context, Limb increment, Search &search) const {
+    const Integer &modulus = context.modulus;
+    Integer constant = Integer::fromLimbs(&increment, 1);
+    auto step = [&](Integer &current) {
+      current = add(context.product(current, current), constant, modulus);
+    };
+    Integer fast(2LL), slow, saved, accumulated(1LL), divisor(1LL);
+    for (size_t range = 1, total = 0;
+         divisor == Integer(1LL) && total < rhoIterations; range *= 2) {
+      slow = fast;
+      for (size_t index = 0; index < range; ++index)
+        step(fast);
+      for (size_t done = 0; done < range && divisor == Integer(1LL);
+           done += 128) {
+        if (stopped(search))
+          return false;
+        saved = fast;
+        for (size_t index = 0; index < std::min<size_t>(128, range - done);
+             ++index) {
+          step(fast);
+          accumulated =
+              context.product(accumulated, subtract(slow, fast, modulus));
+        }
+        divisor = gcd(accumulated, modulus);
+      }
+      total += 2 * range;
+    }
+    if (divisor == modulus)
+      do {
+        step(saved);
+        divisor = gcd(subtract(slow, saved, modulus), modulus);
+      } while (divisor == Integer(1LL));
+    if (divisor == Integer(1LL) || divisor == modulus)
+      return false;
+    search.offer(divisor);
+    return true;
+  }
+
+  static Point doubled(const Modulus &context, const Point &point,
+                       const Integer &a24) {
+    const Integer &modulus = context.modulus;
+    Integer sum = add(point.x, point.z, modulus);
+    Integer difference = subtract(point.x, point.z, modulus);
+    sum = context.product(sum, sum);
+    difference = context.product(difference, difference);
+    Integer cross = subtract(sum, difference, modulus);
+    Integer x = context.product(sum, difference);
+    Integer z = context.product(
+        cross, add(difference, context.product(a24, cross), modulus));
+    return {std::move(x), std::move(z)};
+  }
+
+  static Point added(const Modulus &context, const Point &first,
+                     const Point &second, const Point &difference) {
+    const Integer &modulus = context.modulus;
+    Integer left = context.product(subtract(first.x, first.z, modulus),
+                                   add(second.x, second.z, modulus));
+    Integer right = context.product(add(first.x, first.z, modulus),
+                                    subtract(second.x, second.z, modulus));
+    Integer sum = add(left, right, modulus);
+    Integer cross = subtract(left, right, modulus);
+    return {context.product(difference.z, context.product(sum, sum)),
+            context.product(difference.x, context.product(cross, cross))};
+  }
+
+  static Point multiplied(const Modulus &context, const Point &point,
+                          std::uint64_t scalar, const Integer &a24) {
+    Point low = point, high = doubled(context, point, a24);
+    for (int bit = 62 - __builtin_clzll(scalar); bit >= 0; --bit) {
+      if ((scalar >> bit) & 1) {
+        low = added(context, high, low, point);
+        high = doubled(context, high, a24);
+      } else {
+        high = added(context, high, low, point);
+        low = doubled(context, low, a24);
+      }
+    }
+    return low;
+  }
+
+  bool offerGcd(const Integer &value, const Integer &modulus,
+                Search &search) const {
+    Integer divisor = gcd(value, modulus);
+    if (divisor == Integer(1LL) || divisor == modulus)
+      return false;
+    search.offer(divisor);
+    return true;
+  }
+
+  bool ecm(const Modulus &context, size_t curve, Search &search) const {
+    const Integer &modulus = context.modulus;
+    std::uint64_t stageOne = curveBounds.back().stageOne;
+    for (size_t index = 0, first = 0; index < curveBounds.size(); ++index) {
+      first += curveBounds[index].curves;
+      if (curve < first) {
+        stageOne = curveBounds[index].stageOne;
+        break;
+      }
+    }
+    std::uint64_t stageTwo = stageTwoFactor * stageOne;
+
+    Integer sigma(static_cast<long long>(6 + curve));
+    Integer u = context.reduce(sigma * sigma - Integer(5LL));
+    Integer v = context.reduce(sigma << 2);
+    Integer uCubed = context.multiply(context.multiply(u, u), u);
+    Integer difference = context.reduce(v - u);
+    Integer numerator = context.multiply(
+        context.multiply(context.multiply(difference, difference), difference),
+        context.reduce(u + u + u + v));
+    Integer denominator =
+        context.multiply(context.multiply(uCubed, v), Integer(16LL));
+    auto [divisor, inverse, cofactor] = extendedGcd(denominator, modulus);
+    if (divisor != Integer(1LL)) {
+      if (divisor == modulus)
+        return false;
+      search.offer(divisor);
+      return true;
+    }
+    Integer a24 = context.product(context.multiply(numerator, inverse),
+                                  context.radixSquared);
+    Point point{context.product(uCubed, context.radixSquared),
+                context.product(context.multiply(context.multiply(v, v), v),
+                                context.radixSquared)};
+
+    PrimeSieve sieve(stageTwo);
+    std::uint64_t prime = sieve.next();
+    for (size_t count = 0; prime && prime <= stageOne;
+         prime = sieve.next(), ++count) {
+      if (count % 64 == 0 && stopped(search))
+        return false;
+      std::uint64_t power = prime;
+      while (power <= stageOne / prime)
+        power *= prime;
+      point = multiplied(context, point, power, a24);
+    }
+    if (offerGcd(point.z, modulus, search))
+      return true;
+
+    std::vector<Point> baby(giantStep / 2 + 1);
+    baby[1] = point;
+    Point twice = doubled(context, point, a24);
+    baby[3] = added(context, twice, point, point);
+    for (size_t index = 5; index < baby.size(); index += 2)
+      baby[index] = added(context, baby[index - 2], twice, baby[index - 4]);
+    Point step = multiplied(context, point, giantStep, a24);
+    std::uint64_t block = std::max<std::uint64_t>(stageOne / giantStep, 1);
+    Point current = multiplied(context, point, block * giantStep, a24);
+    Point next = multiplied(context, point, (block + 1) * giantStep, a24);
+    Integer accumulated(1LL);
+    for (size_t count = 0; prime; prime = sieve.next(), ++count) {
+      if (count % 256 == 0 && stopped(search))
+        return false;
+      std::uint64_t target = (prime + giantStep / 2) / giantStep;
+      while (block < target) {
+        Point following = added(context, next, step, current);
+        current = std::move(next);
+        next = std::move(following);
+        ++block;
+      }
+      std::uint64_t offset = prime > block * giantStep
+                                 ? prime - block * giantStep
+                                 : block * giantStep - prime;
+      const Point &small = baby[offset];
+      accumulated = context.product(
+          accumulated, subtract(context.product(current.x, small.z),
+                                context.product(small.x, current.z), modulus));
+    }
+    return offerGcd(accumulated, modulus, search);
+  }
+
+  const Callback &onFactor;
+  Clock::time_point deadline;
+  Factorization result;
+  std::vector<std::pair<Integer, size_t>> pending;
+};
+
+inline Factorization
+factorize(const Integer &number,
+          const Factorizer::Callback &onFactor = nullptr,
+          Factorizer::Clock::duration budget = Factorizer::Clock::duration()) {
+  return Factorizer::factorize(number, onFactor, budget);
+}
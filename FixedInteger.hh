@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <compare>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+template <size_t Capacity> class FixedInteger {
+public:
+  using Limb = std::uint64_t;
+  using DoubleLimb = unsigned __int128;
+
+  static constexpr size_t capacity = Capacity;
+  static constexpr int limbBits = 64;
+
+  constexpr FixedInteger() : limbs{}, count(0), negative(false) {}
+
+  constexpr FixedInteger(long long value) : FixedInteger() {
+    Limb magnitude = value < 0 ? static_cast<Limb>(-(value + 1)) + 1
+                               : static_cast<Limb>(value);
+    if (magnitude != 0)
+      push(magnitude);
+    negative = value < 0;
+  }
+
+  template <size_t Other>
+  constexpr explicit FixedInteger(const FixedInteger<Other> &other)
+      : FixedInteger() {
+    for (size_t index = 0; index < other.size(); ++index)
+      push(other[index]);
+    negative = other.isNegative();
+  }
+
+  static constexpr FixedInteger parse(std::string_view text) {
+    FixedInteger result;
+    size_t start = 0;
+    if (!text.empty() && (text[0] == '-' || text[0] == '+'))
+      start = 1;
+    if (start == text.size())
+      throw std::invalid_argument("Empty FixedInteger");
+    for (size_t index = start; index < text.size(); ++index) {
+      if (text[index] == '\'')
+        continue;
+      if (text[index] < '0' || text[index] > '9')
+        throw std::invalid_argument("Invalid character in FixedInteger");
+      result.multiplyAddLimb(10, static_cast<Limb>(text[index] - '0'));
+    }
+    result.negative = text[0] == '-' && result.count > 0;
+    return result;
+  }
+
+  constexpr size_t size() const { return count; }
+  constexpr bool isZero() const { return count == 0; }
+  constexpr bool isNegative() const { return negative; }
+  constexpr const Limb *data() const { return limbs.data(); }
+  constexpr Limb operator[](size_t index) const { return limbs[index]; }
+
+  constexpr size_t bitLength() const {
+    if (count == 0)
+      return 0;
+    size_t bits = count * limbBits;
+    for (Limb top = limbs[count - 1]; !(top >> (limbBits - 1)); top <<= 1)
+      --bits;
+    return bits;
+  }
+
+  constexpr void multiplyAddLimb(Limb multiplier, Limb addend) {
+    Limb carry = addend;
+    for (size_t index = 0; index < count; ++index) {
+      DoubleLimb product = DoubleLimb(limbs[index]) * multiplier + carry;
+      limbs[index] = static_cast<Limb>(product);
+      carry = static_cast<Limb>(product >> limbBits);
+    }
+    if (carry)
+      push(carry);
+    if (count == 0)
+      negative = false;
+  }
+
+  constexpr FixedInteger operator-() const {
+    FixedInteger result = *this;
+    result.negative = !negative && count > 0;
+    return result;
+  }
+
+  friend constexpr FixedInteger operator+(const FixedInteger &first,
+                                          const FixedInteger &second) {
+    return combine(first, second, second.negative);
+  }
+
+  friend constexpr FixedInteger operator-(const FixedInteger &first,
+                                          const FixedInteger &second) {
+    return combine(first, second, !second.negative);
+  }
+
+  friend constexpr FixedInteger operator*(const FixedInteger &first,
+                                          const FixedInteger &second) {
+    std::array<Limb, 2 * Capacity> product{};
+    for (size_t outer = 0; outer < first.count; ++outer) {
+      Limb carry = 0;
+      for (size_t inner = 0; inner < second.count; ++inner) {
+        DoubleLimb current = DoubleLimb(first.limbs[outer]) *
+                                 second.limbs[inner] +
+                             product[outer + inner] + carry;
+        product[outer + inner] = static_cast<Limb>(current);
+        carry = static_cast<Limb>(current >> limbBits);
+      }
+      product[outer + second.count] = carry;
+    }
+    FixedInteger result;
+    size_t size = first.count + second.count;
+    while (size > 0 && product[size - 1] == 0)
+      --size;
+    for (size_t index = 0; index < size; ++index)
+      result.push(product[index]);
+    result.negative = first.negative != second.negative && size > 0;
+    return result;
+  }
+
+  friend constexpr bool operator==(const FixedInteger &first,
+                                   const FixedInteger &second) {
+    return first.negative == second.negative &&
+           compareMagnitude(first, second) == 0;
+  }
+
+  friend constexpr std::strong_ordering
+  operator<=>(const FixedInteger &first, const FixedInteger &second) {
+    if (first.negative != second.negative)
+      return first.negative ? std::strong_ordering::less
+                            : std::strong_ordering::greater;
+    int order = compareMagnitude(first, second);
+    if (first.negative)
+      order = -order;
+    return order <=> 0;
+  }
+
+private:
+  constexpr void push(Limb limb) {
+    if (count == Capacity)
+      throw std::domain_error("FixedInteger capacity exceeded");
+    limbs[count++] = limb;
+  }
+
+  static constexpr int compareMagnitude(const FixedInteger &first,
+                                        const FixedInteger &second) {
+    if (first.count != second.count)
+      return first.count < second.count ? -1 : 1;
+    for (size_t index = first.count; index > 0; --index)
+      if (first.limbs[index - 1] != second.limbs[index - 1])
+        return first.limbs[index - 1] < second.limbs[index - 1] ? -1 : 1;
+    return 0;
+  }
+
+  static constexpr FixedInteger combine(const FixedInteger &first,
+                                        const FixedInteger &second,
+                                        bool secondNegative) {
+    FixedInteger result;
+    if (first.negative == secondNegative) {
+      Limb carry = 0;
+      for (size_t index = 0; index < std::max(first.count, second.count);
+           ++index) {
+        DoubleLimb current = DoubleLimb(carry) +
+                             (index < first.count ? first.limbs[index] : 0) +
+                             (index < second.count ? second.limbs[index] : 0);
+        result.push(static_cast<Limb>(current));
+        carry = static_cast<Limb>(current >> limbBits);
+      }
+      if (carry)
+        result.push(carry);
+      result.negative = first.negative && result.count > 0;
+      return result;
+    }
+    bool swapped = compareMagnitude(first, second) < 0;
+    const FixedInteger &larger = swapped ? second : first;
+    const FixedInteger &smaller = swapped ? first : second;
+    Limb borrow = 0;
+    for (size_t index = 0; index < larger.count; ++index) {
+      Limb subtrahend = index < smaller.count ? smaller.limbs[index] : 0;
+      Limb difference = larger.limbs[index] - subtrahend - borrow;
+      borrow = larger.limbs[index] < subtrahend ||
+               (larger.limbs[index] == subtrahend && borrow);
+      result.push(difference);
+    }
+    while (result.count > 0 && result.limbs[result.count - 1] == 0)
+      --result.count;
+    result.negative =
+        (swapped ? secondNegative : first.negative) && result.count > 0;
+    return result;
+  }
+
+  std::array<Limb, Capacity> limbs;
+  size_t count;
+  bool negative;
+};
+
+template <char... Digits> consteval auto operator""_big() {
+  constexpr char text[] = {Digits...};
+  constexpr size_t digits = sizeof...(Digits);
+  return FixedInteger<digits * 3322 / 1000 / 64 + 1>::parse(
+      std::string_view(text, digits));
+}
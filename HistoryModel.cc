@@ -0,0 +1,107 @@
+#include "HistoryModel.hh"
+
+HistoryModel::HistoryModel(QObject *parent)
+    : QAbstractListModel(parent), m_limit(size_t(64) << 20), m_used(0) {}
+
+int HistoryModel::rowCount(const QModelIndex &parent) const {
+  return parent.isValid() ? 0 : static_cast<int>(m_entries.size());
+}
+
+QVariant HistoryModel::data(const QModelIndex &index, int role) const {
+  if (role != Qt::DisplayRole || !index.isValid() ||
+      index.row() >= rowCount())
+    return QVariant();
+  const Entry &entry = m_entries[index.row()];
+  return substitute(entry.pattern, entry.previews + entry.texts);
+}
+
+QString HistoryModel::substitute(const QString &pattern,
+                                 const QStringList &arguments) {
+  QString text;
+  for (int position = 0; position < pattern.size(); ++position) {
+    int argument = position + 1 < pattern.size() && pattern[position] == '%'
+                       ? pattern[position + 1].digitValue() - 1
+                       : -1;
+    if (argument >= 0 && argument < arguments.size()) {
+      text += arguments[argument];
+      ++position;
+    } else {
+      text += pattern[position];
+    }
+  }
+  return text;
+}
+
+QString HistoryModel::preview(const QString &number) {
+  int start = !number.isEmpty() && (number[0] == '-' || number[0] == '+');
+  QString sign = start && number[0] == '-' ? "-" : "";
+  int digits = number.size() - start;
+  if (digits <= fullDigits)
+    return sign + number.mid(start);
+  return sign + number.mid(start, previewDigits) + "…" +
+         number.right(previewDigits) + " (" + QString::number(digits) +
+         " зн.)";
+}
+
+void HistoryModel::prepend(const QString &pattern,
+                           std::vector<std::shared_ptr<const Integer>> numbers,
+                           const QStringList &previews,
+                           std::shared_ptr<const Integer> result,
+                           const QStringList &texts) {
+  if (result)
+    numbers.push_back(result);
+  Entry entry{pattern,
+              previews,
+              texts,
+              std::move(numbers),
+              std::move(result),
+              sizeof(Entry) + pattern.size() * sizeof(QChar)};
+  for (const QString &text : entry.previews + entry.texts)
+    entry.bytes += text.size() * sizeof(QChar);
+  for (const std::shared_ptr<const Integer> &number : entry.numbers)
+    entry.bytes += sizeof(Integer) + number->bitLength() / 8;
+  beginInsertRows(QModelIndex(), 0, 0);
+  m_used += entry.bytes;
+  m_entries.push_front(std::move(entry));
+  endInsertRows();
+  trim();
+}
+
+HistoryModel::Entry HistoryModel::entry(int row) const {
+  if (row < 0 || row >= rowCount())
+    return Entry{};
+  return m_entries[row];
+}
+
+QString HistoryModel::fullText(const Entry &entry) {
+  QStringList arguments;
+  for (const std::shared_ptr<const Integer> &number : entry.numbers)
+    arguments.append(QString::fromStdString(number->toString()));
+  return substitute(entry.pattern, arguments + entry.texts);
+}
+
+void HistoryModel::clear() {
+  beginResetModel();
+  m_entries.clear();
+  m_used = 0;
+  endResetModel();
+}
+
+void HistoryModel::setMemoryLimit(size_t bytes) {
+  m_limit = bytes;
+  trim();
+}
+
+void HistoryModel::trim() {
+  size_t keep = m_entries.size();
+  size_t used = m_used;
+  while (keep > 1 && used > m_limit)
+    used -= m_entries[--keep].bytes;
+  if (keep == m_entries.size())
+    return;
+  beginRemoveRows(QModelIndex(), static_cast<int>(keep),
+                  static_cast<int>(m_entries.size()) - 1);
+  m_entries.erase(m_entries.begin() + keep, m_entries.end());
+  m_used = used;
+  endRemoveRows();
+}
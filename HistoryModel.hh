@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QStringList>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "Integer.hh"
+
+class HistoryModel : public QAbstractListModel {
+  Q_OBJECT
+
+public:
+  static constexpr int previewDigits = 4;
+  static constexpr int fullDigits = 20;
+
+  struct Entry {
+    QString pattern;
+    QStringList previews;
+    QStringList texts;
+    std::vector<std::shared_ptr<const Integer>> numbers;
+    std::shared_ptr<const Integer> result;
+    size_t bytes;
+  };
+
+  explicit HistoryModel(QObject *parent = nullptr);
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+  QVariant data(const QModelIndex &index,
+                int role = Qt::DisplayRole) const override;
+
+  void prepend(const QString &pattern,
+               std::vector<std::shared_ptr<const Integer>> numbers,
+               const QStringList &previews,
+               std::shared_ptr<const Integer> result,
+               const QStringList &texts = QStringList());
+  Entry entry(int row) const;
+  void clear();
+
+  static QString preview(const QString &number);
+  static QString fullText(const Entry &entry);
+
+  size_t memoryLimit() const { return m_limit; }
+  size_t memoryUsage() const { return m_used; }
+  void setMemoryLimit(size_t bytes);
+
+private:
+  static QString substitute(const QString &pattern,
+                            const QStringList &arguments);
+  void trim();
+
+  std::deque<Entry> m_entries;
+  size_t m_limit;
+  size_t m_used;
+};
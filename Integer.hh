@@ -1,90 +1,1699 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#if __has_include(<sys/mman.h>)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "FixedInteger.hh"
+#include "LimbKernels.hh"
+#include "Profiler.hh"
+#include "ThreadPool.hh"
+
 class Integer {
-  std::vector<int> digits;
+public:
+  using Limb = std::uint64_t;
+  using DoubleLimb = unsigned __int128;
+
+  static constexpr int limbBits = 64;
+  static constexpr Limb decimalChunk = 10000000000000000000ULL;
+  static constexpr int decimalChunkDigits = 19;
+
+  struct MultiplicationThresholds {
+    size_t karatsuba;
+    size_t toomCook;
+    size_t numberTheoretic;
+  };
+
+  static inline MultiplicationThresholds multiplicationThresholds{32, 600,
+                                                                  12000};
+  static inline size_t burnikelZieglerThreshold = 60;
+  static inline size_t radixConversionThreshold = 30;
+  static inline Limb factorialLimit = 1000000;
+  static inline size_t parallelThreshold = 1000;
+
+  static constexpr size_t tabulatedDecimalLevels = 8;
+
+  static void setThreadCount(size_t count) {
+    ThreadState &state = threadState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.count = std::max<size_t>(count, 1);
+    state.pool.reset();
+  }
+
+  static size_t threadCount() {
+    ThreadState &state = threadState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return state.count;
+  }
+
+  class Cancelled : public std::runtime_error {
+  public:
+    Cancelled() : std::runtime_error("Operation cancelled") {}
+  };
+
+  class CancellationScope {
+    const std::atomic<bool> *previous;
+
+  public:
+    explicit CancellationScope(const std::atomic<bool> &flag)
+        : previous(cancellationFlag) {
+      cancellationFlag = &flag;
+    }
+    ~CancellationScope() { cancellationFlag = previous; }
+    CancellationScope(const CancellationScope &) = delete;
+    CancellationScope &operator=(const CancellationScope &) = delete;
+  };
+
+  static void checkCancellation() {
+    if (cancellationFlag && cancellationFlag->load(std::memory_order_relaxed))
+      throw Cancelled();
+  }
+
+  class Magnitude {
+    const Limb *data;
+    size_t size;
+
+    Magnitude(const Limb *limbData, size_t limbCount)
+        : data(limbData), size(limbCount) {}
+
+    friend class Integer;
+
+  public:
+    explicit Magnitude(const Integer &value)
+        : data(value.limbs.data()), size(value.limbs.size()) {}
+
+    size_t limbCount() const { return size; }
+    bool isZero() const { return size == 0; }
+
+    int compare(Magnitude other) const {
+      if (size != other.size)
+        return size < other.size ? -1 : 1;
+      return LimbKernels::compare(data, other.data, size);
+    }
+
+    bool operator==(Magnitude other) const { return compare(other) == 0; }
+    bool operator!=(Magnitude other) const { return compare(other) != 0; }
+    bool operator<(Magnitude other) const { return compare(other) < 0; }
+    bool operator>(Magnitude other) const { return compare(other) > 0; }
+    bool operator<=(Magnitude other) const { return compare(other) <= 0; }
+    bool operator>=(Magnitude other) const { return compare(other) >= 0; }
+  };
+
+private:
+  static constexpr size_t fileHeaderLimbs = 4;
+  static constexpr size_t mappingThreshold = 512;
+  static constexpr char fileMagic[8] = {'I', 'N', 'T', 'E', 'G', 'E', 'R', 0};
+  static constexpr std::uint32_t fileVersion = 1;
+
+  class LimbVector {
+    static constexpr size_t inlineCapacity = 2;
+    static constexpr size_t mappedFlag = size_t(1) << (sizeof(size_t) * 8 - 1);
+
+    Limb *pointer;
+    size_t count;
+    size_t reserved;
+    Limb inlineLimbs[inlineCapacity];
+
+    bool isInline() const { return pointer == inlineLimbs; }
+    bool isMapped() const { return reserved & mappedFlag; }
+
+    void releaseStorage() {
+      if (isInline())
+        return;
+#if __has_include(<sys/mman.h>)
+      if (isMapped()) {
+        ::munmap(pointer - fileHeaderLimbs,
+                 (fileHeaderLimbs + capacity()) * sizeof(Limb));
+        return;
+      }
+#endif
+      ::operator delete(pointer);
+    }
+
+    void reallocate(size_t capacity) {
+      PROFILE_ALLOCATION(capacity * sizeof(Limb));
+      Limb *replacement =
+          static_cast<Limb *>(::operator new(capacity * sizeof(Limb)));
+      std::copy(pointer, pointer + count, replacement);
+      releaseStorage();
+      pointer = replacement;
+      reserved = capacity;
+    }
+
+    void grow(size_t size) {
+      if (size > capacity())
+        reallocate(std::max(size, 2 * capacity()));
+    }
+
+  public:
+    LimbVector()
+        : pointer(inlineLimbs), count(0), reserved(inlineCapacity) {}
+    LimbVector(const LimbVector &other) : LimbVector() {
+      assign(other.begin(), other.end());
+    }
+    LimbVector(LimbVector &&other) noexcept : LimbVector() {
+      *this = std::move(other);
+    }
+    ~LimbVector() { releaseStorage(); }
+
+    LimbVector &operator=(const LimbVector &other) {
+      if (this != &other)
+        assign(other.begin(), other.end());
+      return *this;
+    }
+
+    LimbVector &operator=(LimbVector &&other) noexcept {
+      if (this == &other)
+        return *this;
+      if (other.isInline()) {
+        std::copy(other.pointer, other.pointer + other.count, pointer);
+        count = other.count;
+      } else {
+        releaseStorage();
+        pointer = other.pointer;
+        count = other.count;
+        reserved = other.reserved;
+        other.pointer = other.inlineLimbs;
+        other.reserved = inlineCapacity;
+      }
+      other.count = 0;
+      return *this;
+    }
+
+    void swap(LimbVector &other) noexcept {
+      LimbVector temporary(std::move(other));
+      other = std::move(*this);
+      *this = std::move(temporary);
+    }
+
+    void adoptMapping(Limb *data, size_t mapped, size_t size) {
+      releaseStorage();
+      pointer = data;
+      count = size;
+      reserved = mapped | mappedFlag;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    size_t capacity() const { return reserved & ~mappedFlag; }
+
+    Limb *data() { return pointer; }
+    const Limb *data() const { return pointer; }
+    Limb *begin() { return pointer; }
+    const Limb *begin() const { return pointer; }
+    Limb *end() { return pointer + count; }
+    const Limb *end() const { return pointer + count; }
+    Limb &operator[](size_t index) { return pointer[index]; }
+    const Limb &operator[](size_t index) const { return pointer[index]; }
+    Limb &back() { return pointer[count - 1]; }
+    const Limb &back() const { return pointer[count - 1]; }
+
+    void reserve(size_t capacity) {
+      if (capacity > this->capacity())
+        reallocate(capacity);
+    }
+
+    void resize(size_t size, Limb value = 0) {
+      grow(size);
+      if (size > count)
+        std::fill(pointer + count, pointer + size, value);
+      count = size;
+    }
+
+    void resizeUninitialized(size_t size) {
+      grow(size);
+      count = size;
+    }
+
+    void assign(size_t size, Limb value) {
+      count = 0;
+      resize(size, value);
+    }
+
+    void assign(const Limb *first, const Limb *last) {
+      count = 0;
+      grow(static_cast<size_t>(last - first));
+      count = static_cast<size_t>(std::copy(first, last, pointer) - pointer);
+    }
+
+    void push_back(Limb value) {
+      grow(count + 1);
+      pointer[count++] = value;
+    }
+
+    void pop_back() { --count; }
+    void clear() { count = 0; }
+
+    void erase(Limb *first, Limb *last) {
+      std::copy(last, end(), first);
+      count -= static_cast<size_t>(last - first);
+    }
+
+    bool operator==(const LimbVector &other) const {
+      return count == other.count && std::equal(begin(), end(), other.begin());
+    }
+  };
+
+  class ScratchArena {
+    struct Block {
+      std::unique_ptr<Limb[]> limbs;
+      size_t capacity;
+    };
+
+    std::vector<Block> blocks;
+    size_t block;
+    size_t offset;
+    size_t depth;
+
+  public:
+    ScratchArena() : block(0), offset(0), depth(0) {}
+
+    static constexpr size_t minimumBlock = 1 << 12;
+    static constexpr size_t retainedLimbs = 1 << 20;
+
+    Limb *allocate(size_t size, size_t &savedBlock, size_t &savedOffset) {
+      savedBlock = block;
+      savedOffset = offset;
+      ++depth;
+      while (block < blocks.size() && offset + size > blocks[block].capacity) {
+        ++block;
+        offset = 0;
+      }
+      if (block == blocks.size()) {
+        size_t capacity = std::max(
+            size, blocks.empty() ? minimumBlock : 2 * blocks.back().capacity);
+        PROFILE_ALLOCATION(capacity * sizeof(Limb));
+        blocks.push_back({std::make_unique_for_overwrite<Limb[]>(capacity),
+                          capacity});
+        offset = 0;
+      }
+      Limb *result = blocks[block].limbs.get() + offset;
+      offset += size;
+      return result;
+    }
+
+    void release(size_t savedBlock, size_t savedOffset) {
+      block = savedBlock;
+      offset = savedOffset;
+      if (--depth > 0)
+        return;
+      size_t total = 0;
+      for (const Block &current : blocks)
+        total += current.capacity;
+      if (blocks.size() <= 1 && total <= retainedLimbs)
+        return;
+      blocks.clear();
+      if (total <= retainedLimbs)
+        blocks.push_back(
+            {std::make_unique_for_overwrite<Limb[]>(total), total});
+    }
+  };
+
+  class Scratch {
+    Limb *pointer;
+    size_t savedBlock;
+    size_t savedOffset;
+
+  public:
+    explicit Scratch(size_t size)
+        : pointer(scratchArena.allocate(size, savedBlock, savedOffset)) {}
+    Scratch(size_t size, Limb value) : Scratch(size) {
+      std::fill(pointer, pointer + size, value);
+    }
+    ~Scratch() { scratchArena.release(savedBlock, savedOffset); }
+    Scratch(const Scratch &) = delete;
+    Scratch &operator=(const Scratch &) = delete;
+
+    Limb *data() const { return pointer; }
+    Limb &operator[](size_t index) const { return pointer[index]; }
+  };
+
+  static inline thread_local const std::atomic<bool> *cancellationFlag =
+      nullptr;
+  static inline thread_local ScratchArena scratchArena;
+  static inline thread_local LimbVector spareLimbs;
+  static constexpr size_t spareLimbCapacity = 1 << 16;
+
+  struct ThreadState {
+    std::mutex mutex;
+    std::shared_ptr<ThreadPool> pool;
+    size_t count;
+  };
+
+  static ThreadState &threadState() {
+    static ThreadState state{
+        {}, nullptr, std::max<size_t>(std::thread::hardware_concurrency(), 1)};
+    return state;
+  }
+
+  static std::shared_ptr<ThreadPool> threadPool() {
+    ThreadState &state = threadState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    if (!state.pool && state.count > 1)
+      state.pool = std::make_shared<ThreadPool>(state.count - 1);
+    return state.pool;
+  }
+
+  template <typename Function>
+  static void parallelFor(size_t count, bool parallel, const Function &body) {
+    std::shared_ptr<ThreadPool> pool =
+        parallel && count > 1 ? threadPool() : nullptr;
+    if (!pool) {
+      for (size_t index = 0; index < count; ++index)
+        body(index);
+      return;
+    }
+    const std::atomic<bool> *flag = cancellationFlag;
+    TaskGroup group(*pool);
+    for (size_t index = 1; index < count; ++index)
+      group.run([&body, flag, index] {
+        if (!flag) {
+          body(index);
+          return;
+        }
+        CancellationScope scope(*flag);
+        body(index);
+      });
+    body(0);
+    group.wait();
+  }
+
+  template <typename Function>
+  static void parallelRange(size_t count, size_t grain, const Function &body) {
+    std::shared_ptr<ThreadPool> pool =
+        count >= 2 * grain ? threadPool() : nullptr;
+    size_t pieces = pool ? std::min(count / grain, pool->size() + 1) : 1;
+    parallelFor(pieces, pieces > 1, [&](size_t piece) {
+      body(count * piece / pieces, count * (piece + 1) / pieces);
+    });
+  }
+
+  LimbVector limbs;
   bool negative;
 
-  void removeLeadingZeros() {
-    while (digits.size() > 1 && digits.back() == 0)
-      digits.pop_back();
-    if (digits.size() == 1 && digits[0] == 0)
-      negative = false;
+  static void storeLittle(char *output, std::uint64_t value, size_t bytes) {
+    for (size_t index = 0; index < bytes; ++index)
+      output[index] = static_cast<char>(value >> (8 * index));
+  }
+
+  static std::uint64_t loadLittle(const char *input, size_t bytes) {
+    std::uint64_t value = 0;
+    for (size_t index = 0; index < bytes; ++index)
+      value |= static_cast<std::uint64_t>(static_cast<unsigned char>(
+                   input[index]))
+               << (8 * index);
+    return value;
+  }
+
+  static bool mapLimbs(const std::string &path, size_t size,
+                       LimbVector &output) {
+#if __has_include(<sys/mman.h>)
+    if (std::endian::native != std::endian::little || size < mappingThreshold)
+      return false;
+    int descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor < 0)
+      return false;
+    size_t length = (fileHeaderLimbs + size) * sizeof(Limb);
+    struct stat status;
+    void *mapping = MAP_FAILED;
+    if (::fstat(descriptor, &status) == 0 &&
+        static_cast<std::uint64_t>(status.st_size) >= length)
+      mapping = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                       descriptor, 0);
+    ::close(descriptor);
+    if (mapping == MAP_FAILED)
+      return false;
+    output.adoptMapping(static_cast<Limb *>(mapping) + fileHeaderLimbs, size,
+                        size);
+    return true;
+#else
+    static_cast<void>(path);
+    static_cast<void>(size);
+    static_cast<void>(output);
+    return false;
+#endif
+  }
+
+  void removeLeadingZeros() {
+    while (!limbs.empty() && limbs.back() == 0)
+      limbs.pop_back();
+    if (limbs.empty())
+      negative = false;
+  }
+
+  static int compareAbsolute(const Integer &first, const Integer &second) {
+    return first.magnitude().compare(second.magnitude());
+  }
+
+  static Integer fromLimbs(const Limb *data, size_t size) {
+    Integer result;
+    result.limbs.assign(data, data + size);
+    result.removeLeadingZeros();
+    return result;
+  }
+
+  static size_t trimmedSize(const Limb *data, size_t size) {
+    while (size > 0 && data[size - 1] == 0)
+      --size;
+    return size;
+  }
+
+  static Limb addLimbs(Limb *target, size_t targetSize, const Limb *source,
+                       size_t sourceSize) {
+    Limb carry = LimbKernels::add(target, target, source, sourceSize);
+    for (size_t index = sourceSize; carry && index < targetSize; ++index)
+      carry = ++target[index] == 0;
+    return carry;
+  }
+
+  static Limb subtractLimbs(Limb *target, size_t targetSize,
+                            const Limb *source, size_t sourceSize) {
+    Limb borrow = LimbKernels::subtract(target, target, source, sourceSize);
+    for (size_t index = sourceSize; borrow && index < targetSize; ++index)
+      borrow = target[index]-- == 0;
+    return borrow;
+  }
+
+  static Limb addMultipleLimbs(Limb *target, const Limb *source, size_t size,
+                               Limb multiplier) {
+    Limb carry = 0;
+    for (size_t index = 0; index < size; ++index) {
+      DoubleLimb sum = static_cast<DoubleLimb>(source[index]) * multiplier +
+                       target[index] + carry;
+      target[index] = static_cast<Limb>(sum);
+      carry = static_cast<Limb>(sum >> limbBits);
+    }
+    return carry;
+  }
+
+  static Limb subtractMultipleLimbs(Limb *target, const Limb *source,
+                                    size_t size, Limb multiplier) {
+    Limb carry = 0;
+    for (size_t index = 0; index < size; ++index) {
+      DoubleLimb product =
+          static_cast<DoubleLimb>(source[index]) * multiplier + carry;
+      Limb low = static_cast<Limb>(product);
+      carry = static_cast<Limb>(product >> limbBits) + (target[index] < low);
+      target[index] -= low;
+    }
+    return carry;
+  }
+
+  static void negateLimbs(Limb *data, size_t size) {
+    Limb carry = 1;
+    for (size_t index = 0; index < size; ++index) {
+      data[index] = ~data[index] + carry;
+      carry = carry && data[index] == 0;
+    }
+  }
+
+  static LimbVector takeSpareLimbs(size_t size) {
+    LimbVector buffer = std::move(spareLimbs);
+    buffer.resize(size);
+    return buffer;
+  }
+
+  static void releaseSpareLimbs(LimbVector &&buffer) {
+    if (buffer.capacity() <= spareLimbCapacity &&
+        buffer.capacity() > spareLimbs.capacity())
+      spareLimbs = std::move(buffer);
+  }
+
+  static DoubleLimb smallMagnitude(const Limb *data, size_t size) {
+    DoubleLimb magnitude = size > 0 ? data[0] : 0;
+    if (size > 1)
+      magnitude |= static_cast<DoubleLimb>(data[1]) << limbBits;
+    return magnitude;
+  }
+
+  void assignSmall(DoubleLimb magnitude, bool isNegative) {
+    limbs.resize(2);
+    limbs[0] = static_cast<Limb>(magnitude);
+    limbs[1] = static_cast<Limb>(magnitude >> limbBits);
+    negative = isNegative;
+    removeLeadingZeros();
+  }
+
+  static bool multiplySmall(Integer &target, const Integer &first,
+                            const Integer &second) {
+    if (first.limbs.size() > 2 || second.limbs.size() > 2)
+      return false;
+    DoubleLimb product;
+    if (__builtin_mul_overflow(
+            smallMagnitude(first.limbs.data(), first.limbs.size()),
+            smallMagnitude(second.limbs.data(), second.limbs.size()),
+            &product))
+      return false;
+    target.assignSmall(product, first.negative != second.negative);
+    return true;
+  }
+
+  void accumulate(const Limb *data, size_t size, bool sourceNegative) {
+    if (limbs.empty())
+      negative = sourceNegative;
+    if (limbs.size() <= 2 && size <= 2) {
+      DoubleLimb current = smallMagnitude(limbs.data(), limbs.size());
+      DoubleLimb source = smallMagnitude(data, size);
+      DoubleLimb total;
+      if (negative != sourceNegative) {
+        bool larger = current >= source;
+        assignSmall(larger ? current - source : source - current,
+                    larger ? negative : sourceNegative);
+        return;
+      }
+      if (!__builtin_add_overflow(current, source, &total)) {
+        assignSmall(total, negative);
+        return;
+      }
+    }
+    if (negative == sourceNegative) {
+      if (limbs.size() < size)
+        limbs.resize(size, 0);
+      if (addLimbs(limbs.data(), limbs.size(), data, size))
+        limbs.push_back(1);
+    } else if (magnitude().compare(Magnitude(data, size)) >= 0) {
+      subtractLimbs(limbs.data(), limbs.size(), data, size);
+    } else {
+      limbs.resize(size, 0);
+      LimbKernels::subtract(limbs.data(), data, limbs.data(), size);
+      negative = sourceNegative;
+    }
+    removeLeadingZeros();
+  }
+
+  void accumulateMultiple(const Integer &source, Limb multiplier,
+                          bool sourceNegative) {
+    size_t size = source.limbs.size();
+    if (size == 0 || multiplier == 0)
+      return;
+    if (limbs.empty())
+      negative = sourceNegative;
+    if (limbs.size() <= size)
+      limbs.resize(size + 1, 0);
+    Limb *target = limbs.data();
+    size_t targetSize = limbs.size();
+    if (negative == sourceNegative) {
+      Limb carry =
+          addMultipleLimbs(target, source.limbs.data(), size, multiplier);
+      if (addLimbs(target + size, targetSize - size, &carry, 1))
+        limbs.push_back(1);
+    } else {
+      Limb borrow =
+          subtractMultipleLimbs(target, source.limbs.data(), size, multiplier);
+      if (subtractLimbs(target + size, targetSize - size, &borrow, 1)) {
+        negateLimbs(target, targetSize);
+        negative = !negative;
+      }
+    }
+    removeLeadingZeros();
+  }
+
+  static void multiplyAccumulate(Integer &target, const Integer &first,
+                                 const Integer &second, bool subtract) {
+    bool productNegative = (first.negative != second.negative) != subtract;
+    if (second.limbs.size() == 1) {
+      target.accumulateMultiple(first, second.limbs[0], productNegative);
+    } else if (first.limbs.size() == 1) {
+      target.accumulateMultiple(second, first.limbs[0], productNegative);
+    } else if (!first.isZero() && !second.isZero()) {
+      size_t size = first.limbs.size() + second.limbs.size();
+      Scratch product(size);
+      multiplyLimbs(product.data(), first.limbs.data(), first.limbs.size(),
+                    second.limbs.data(), second.limbs.size());
+      target.accumulate(product.data(), trimmedSize(product.data(), size),
+                        productNegative);
+    }
+  }
+
+  static Integer sum(const Integer &first, const Integer &second,
+                     bool secondNegative) {
+    Integer result;
+    if (first.limbs.size() <= 2 && second.limbs.size() <= 2) {
+      result = first;
+      result.accumulate(second.limbs.data(), second.limbs.size(),
+                        secondNegative);
+      return result;
+    }
+    bool subtract = first.negative != secondNegative;
+    int comparison = subtract ? compareAbsolute(first, second)
+                     : first.limbs.size() >= second.limbs.size() ? 1
+                                                                  : -1;
+    if (comparison == 0)
+      return result;
+    const Integer &larger = comparison > 0 ? first : second;
+    const Integer &smaller = comparison > 0 ? second : first;
+    size_t largeSize = larger.limbs.size(), smallSize = smaller.limbs.size();
+    result.limbs.resizeUninitialized(largeSize + 1);
+    Limb *output = result.limbs.data();
+    const Limb *large = larger.limbs.data();
+    std::copy(large + smallSize, large + largeSize, output + smallSize);
+    if (subtract) {
+      Limb borrow = LimbKernels::subtract(output, large, smaller.limbs.data(),
+                                          smallSize);
+      for (size_t index = smallSize; borrow && index < largeSize; ++index)
+        borrow = output[index]-- == 0;
+      output[largeSize] = 0;
+    } else {
+      Limb carry =
+          LimbKernels::add(output, large, smaller.limbs.data(), smallSize);
+      for (size_t index = smallSize; carry && index < largeSize; ++index)
+        carry = ++output[index] == 0;
+      output[largeSize] = carry;
+    }
+    result.negative = comparison > 0 ? first.negative : secondNegative;
+    result.removeLeadingZeros();
+    return result;
+  }
+
+  static void multiplyBasecase(Limb *result, const Limb *first,
+                               size_t firstSize, const Limb *second,
+                               size_t secondSize) {
+    std::fill(result, result + firstSize + secondSize, 0);
+    for (size_t i = 0; i < secondSize; ++i) {
+      Limb carry = 0;
+      for (size_t j = 0; j < firstSize; ++j) {
+        DoubleLimb current =
+            static_cast<DoubleLimb>(first[j]) * second[i] + result[i + j] +
+            carry;
+        result[i + j] = static_cast<Limb>(current);
+        carry = static_cast<Limb>(current >> limbBits);
+      }
+      result[i + firstSize] = carry;
+    }
+  }
+
+  static void squareBasecase(Limb *result, const Limb *value, size_t size) {
+    std::fill(result, result + 2 * size, 0);
+    for (size_t i = 0; i < size; ++i) {
+      Limb carry = 0;
+      for (size_t j = i + 1; j < size; ++j) {
+        DoubleLimb current = static_cast<DoubleLimb>(value[i]) * value[j] +
+                             result[i + j] + carry;
+        result[i + j] = static_cast<Limb>(current);
+        carry = static_cast<Limb>(current >> limbBits);
+      }
+      result[i + size] = carry;
+    }
+    Limb carry = 0;
+    for (size_t index = 0; index < 2 * size; ++index) {
+      Limb next = result[index] >> (limbBits - 1);
+      result[index] = (result[index] << 1) | carry;
+      carry = next;
+    }
+    carry = 0;
+    for (size_t i = 0; i < size; ++i) {
+      DoubleLimb product = static_cast<DoubleLimb>(value[i]) * value[i];
+      DoubleLimb low =
+          static_cast<DoubleLimb>(result[2 * i]) + static_cast<Limb>(product) +
+          carry;
+      result[2 * i] = static_cast<Limb>(low);
+      DoubleLimb high = static_cast<DoubleLimb>(result[2 * i + 1]) +
+                        static_cast<Limb>(product >> limbBits) +
+                        static_cast<Limb>(low >> limbBits);
+      result[2 * i + 1] = static_cast<Limb>(high);
+      carry = static_cast<Limb>(high >> limbBits);
+    }
+  }
+
+  static void multiplyUnbalanced(Limb *result, const Limb *first,
+                                 size_t firstSize, const Limb *second,
+                                 size_t secondSize) {
+    std::fill(result, result + firstSize + secondSize, 0);
+    Scratch partial(2 * secondSize);
+    for (size_t offset = 0; offset < firstSize; offset += secondSize) {
+      checkCancellation();
+      size_t chunk = std::min(secondSize, firstSize - offset);
+      multiplyLimbs(partial.data(), first + offset, chunk, second, secondSize);
+      addLimbs(result + offset, firstSize + secondSize - offset,
+               partial.data(), chunk + secondSize);
+    }
+  }
+
+  static void multiplyKaratsuba(Limb *result, const Limb *first,
+                                size_t firstSize, const Limb *second,
+                                size_t secondSize) {
+    checkCancellation();
+    bool squaring = first == second && firstSize == secondSize;
+    size_t half = (firstSize + 1) / 2;
+    size_t firstHighSize = firstSize - half;
+    size_t secondLowSize = std::min(half, secondSize);
+    size_t secondHighSize = secondSize - secondLowSize;
+    size_t resultSize = firstSize + secondSize;
+
+    std::fill(result, result + resultSize, 0);
+
+    Scratch firstSum(half + 1);
+    std::copy(first, first + half, firstSum.data());
+    firstSum[half] =
+        addLimbs(firstSum.data(), half, first + half, firstHighSize);
+    size_t firstSumSize = trimmedSize(firstSum.data(), half + 1);
+    Scratch secondSum(squaring ? 0 : half + 1, 0);
+    size_t secondSumSize = firstSumSize;
+    if (!squaring) {
+      std::copy(second, second + secondLowSize, secondSum.data());
+      addLimbs(secondSum.data(), half + 1, second + half, secondHighSize);
+      secondSumSize = trimmedSize(secondSum.data(), half + 1);
+    }
+    const Limb *secondSumData = squaring ? firstSum.data() : secondSum.data();
+
+    size_t middleSize = std::max(firstSumSize + secondSumSize, resultSize);
+    Scratch middle(middleSize, 0);
+    parallelFor(3, secondSize >= parallelThreshold, [&](size_t product) {
+      if (product == 0)
+        multiplyLimbs(result, first, half, second, secondLowSize);
+      else if (product == 1 && secondHighSize)
+        multiplyLimbs(result + 2 * half, first + half, firstHighSize,
+                      second + half, secondHighSize);
+      else if (product == 2 && firstSumSize && secondSumSize)
+        multiplyLimbs(middle.data(), firstSum.data(), firstSumSize,
+                      secondSumData, secondSumSize);
+    });
+    subtractLimbs(middle.data(), middleSize, result, half + secondLowSize);
+    subtractLimbs(middle.data(), middleSize, result + 2 * half,
+                  resultSize - 2 * half);
+    addLimbs(result + half, resultSize - half, middle.data(),
+             trimmedSize(middle.data(), middleSize));
+  }
+
+  static void multiplyToomCook3(Limb *result, const Limb *first,
+                                size_t firstSize, const Limb *second,
+                                size_t secondSize) {
+    checkCancellation();
+    bool squaring = first == second && firstSize == secondSize;
+    size_t part = (firstSize + 2) / 3;
+    auto slice = [part](const Limb *data, size_t size, size_t index) {
+      size_t begin = std::min(size, index * part);
+      size_t end = std::min(size, begin + part);
+      return fromLimbs(data + begin, end - begin);
+    };
+    auto evaluate = [](const Integer &low, const Integer &middle,
+                       const Integer &high) {
+      Integer outer = low + high;
+      Integer atMinusTwo = low - middle - middle + high + high + high + high;
+      return std::array<Integer, 5>{low, outer + middle, outer - middle,
+                                    atMinusTwo, high};
+    };
+    std::array<Integer, 5> firstPoints =
+        evaluate(slice(first, firstSize, 0), slice(first, firstSize, 1),
+                 slice(first, firstSize, 2));
+    std::array<Integer, 5> secondPoints;
+    if (!squaring)
+      secondPoints =
+          evaluate(slice(second, secondSize, 0), slice(second, secondSize, 1),
+                   slice(second, secondSize, 2));
+
+    std::array<Integer, 5> values;
+    parallelFor(values.size(), secondSize >= parallelThreshold,
+                [&](size_t index) {
+                  values[index] =
+                      squaring ? square(firstPoints[index])
+                               : firstPoints[index] * secondPoints[index];
+                });
+
+    Integer &atZero = values[0], &atOne = values[1], &atMinusOne = values[2],
+            &atMinusTwo = values[3], &atInfinity = values[4];
+    Integer cubic = atMinusTwo - atOne;
+    cubic.divideByLimb(3);
+    Integer linear = atOne - atMinusOne;
+    linear.divideByLimb(2);
+    Integer quadratic = atMinusOne - atZero;
+    cubic = quadratic - cubic;
+    cubic.divideByLimb(2);
+    cubic += atInfinity;
+    cubic += atInfinity;
+    quadratic += linear;
+    quadratic -= atInfinity;
+    linear -= cubic;
+
+    size_t resultSize = firstSize + secondSize;
+    std::fill(result, result + resultSize, 0);
+    const Integer *coefficients[] = {&atZero, &linear, &quadratic, &cubic,
+                                     &atInfinity};
+    for (size_t index = 0; index < 5; ++index) {
+      const LimbVector &coefficient = coefficients[index]->limbs;
+      if (!coefficient.empty())
+        addLimbs(result + index * part, resultSize - index * part,
+                 coefficient.data(), coefficient.size());
+    }
+  }
+
+  struct NumberTheoreticPrime {
+    Limb modulus;
+    Limb generator;
+    Limb negatedInverse;
+    Limb montgomerySquare;
+
+    NumberTheoreticPrime(Limb prime, Limb root)
+        : modulus(prime), generator(root), negatedInverse(0),
+          montgomerySquare(0) {
+      Limb inverse = prime;
+      for (int step = 0; step < 6; ++step)
+        inverse *= 2 - prime * inverse;
+      negatedInverse = 0 - inverse;
+      DoubleLimb radix = (static_cast<DoubleLimb>(1) << limbBits) % prime;
+      montgomerySquare = static_cast<Limb>(radix * radix % prime);
+    }
+
+    Limb reduce(DoubleLimb value) const {
+      Limb factor = static_cast<Limb>(value) * negatedInverse;
+      Limb reduced = static_cast<Limb>(
+          (value + static_cast<DoubleLimb>(factor) * modulus) >> limbBits);
+      return reduced >= modulus ? reduced - modulus : reduced;
+    }
+    Limb multiply(Limb first, Limb second) const {
+      return reduce(static_cast<DoubleLimb>(first) * second);
+    }
+    Limb toMontgomery(Limb value) const {
+      return multiply(value, montgomerySquare);
+    }
+    Limb power(Limb base, Limb exponent) const {
+      Limb result = toMontgomery(1);
+      for (base = toMontgomery(base); exponent; exponent >>= 1) {
+        if (exponent & 1)
+          result = multiply(result, base);
+        base = multiply(base, base);
+      }
+      return reduce(result);
+    }
+
+    Limb add(Limb first, Limb second) const {
+      Limb sum = first + second;
+      return sum >= modulus ? sum - modulus : sum;
+    }
+    Limb subtract(Limb first, Limb second) const {
+      return first >= second ? first - second : first + modulus - second;
+    }
+
+    void rootTable(Limb *roots, size_t size, bool inverse) const {
+      for (size_t half = 1; half < size; half <<= 1) {
+        Limb root = power(generator, (modulus - 1) / (2 * half));
+        if (inverse)
+          root = power(root, modulus - 2);
+        root = toMontgomery(root);
+        roots[half] = toMontgomery(1);
+        for (size_t index = 1; index < half; ++index)
+          roots[half + index] = multiply(roots[half + index - 1], root);
+      }
+    }
+
+    static constexpr size_t butterflyGrain = 1 << 14;
+
+    void forwardTransform(Limb *values, size_t size, const Limb *roots) const {
+      for (size_t half = size / 2; half > 0; half >>= 1)
+        parallelRange(size / 2, butterflyGrain, [&](size_t begin, size_t end) {
+          for (size_t index = begin; index < end; ++index) {
+            size_t offset = index & (half - 1);
+            Limb &low = values[2 * index - offset];
+            Limb &high = values[2 * index - offset + half];
+            Limb sum = add(low, high);
+            high = multiply(subtract(low, high), roots[half + offset]);
+            low = sum;
+          }
+        });
+    }
+
+    void inverseTransform(Limb *values, size_t size, const Limb *roots) const {
+      for (size_t half = 1; half < size; half <<= 1)
+        parallelRange(size / 2, butterflyGrain, [&](size_t begin, size_t end) {
+          for (size_t index = begin; index < end; ++index) {
+            size_t offset = index & (half - 1);
+            Limb &low = values[2 * index - offset];
+            Limb &high = values[2 * index - offset + half];
+            Limb product = multiply(high, roots[half + offset]);
+            high = subtract(low, product);
+            low = add(low, product);
+          }
+        });
+    }
+
+    void convolve(Limb *output, const Limb *first, size_t firstSize,
+                  const Limb *second, size_t secondSize, size_t size) const {
+      checkCancellation();
+      Scratch roots(std::max<size_t>(size, 2));
+      rootTable(roots.data(), size, false);
+      for (size_t index = 0; index < size; ++index)
+        output[index] = index < firstSize ? toMontgomery(first[index]) : 0;
+      forwardTransform(output, size, roots.data());
+      if (first == second && firstSize == secondSize) {
+        for (size_t index = 0; index < size; ++index)
+          output[index] = multiply(output[index], output[index]);
+      } else {
+        Scratch secondValues(size);
+        for (size_t index = 0; index < size; ++index)
+          secondValues[index] =
+              index < secondSize ? toMontgomery(second[index]) : 0;
+        forwardTransform(secondValues.data(), size, roots.data());
+        for (size_t index = 0; index < size; ++index)
+          output[index] = multiply(output[index], secondValues[index]);
+      }
+      rootTable(roots.data(), size, true);
+      inverseTransform(output, size, roots.data());
+      Limb scale = power(size % modulus, modulus - 2);
+      for (size_t index = 0; index < size; ++index)
+        output[index] = multiply(output[index], scale);
+    }
+  };
+
+  static void multiplyNumberTheoretic(Limb *result, const Limb *first,
+                                      size_t firstSize, const Limb *second,
+                                      size_t secondSize) {
+    checkCancellation();
+    static const std::array<NumberTheoreticPrime, 3> numberTheoreticPrimes{
+        NumberTheoreticPrime(4179340454199820289ULL, 3),
+        NumberTheoreticPrime(2485986994308513793ULL, 5),
+        NumberTheoreticPrime(1945555039024054273ULL, 5)};
+    bool squaring = first == second && firstSize == secondSize;
+    auto split = [](Limb *pieces, const Limb *data, size_t size) {
+      for (size_t index = 0; index < size; ++index) {
+        pieces[2 * index] = data[index] & 0xffffffffULL;
+        pieces[2 * index + 1] = data[index] >> 32;
+      }
+    };
+    Scratch firstPieces(2 * firstSize);
+    split(firstPieces.data(), first, firstSize);
+    Scratch secondPieces(squaring ? 0 : 2 * secondSize);
+    if (!squaring)
+      split(secondPieces.data(), second, secondSize);
+    const Limb *secondOperand =
+        squaring ? firstPieces.data() : secondPieces.data();
+    size_t outputSize = 2 * (firstSize + secondSize);
+    size_t size = 1;
+    while (size < outputSize)
+      size <<= 1;
+
+    Scratch residues(3 * size);
+    parallelFor(3, secondSize >= parallelThreshold, [&](size_t prime) {
+      numberTheoreticPrimes[prime].convolve(
+          residues.data() + prime * size, firstPieces.data(), 2 * firstSize,
+          secondOperand, 2 * secondSize, size);
+    });
+
+    const NumberTheoreticPrime &p1 = numberTheoreticPrimes[0];
+    const NumberTheoreticPrime &p2 = numberTheoreticPrimes[1];
+    const NumberTheoreticPrime &p3 = numberTheoreticPrimes[2];
+    auto multiplyModulo = [](Limb first, Limb second, Limb modulus) {
+      return static_cast<Limb>(static_cast<DoubleLimb>(first) * second %
+                               modulus);
+    };
+    Limb inverse12 = p2.power(p1.modulus % p2.modulus, p2.modulus - 2);
+    Limb inverse13 = p3.power(p1.modulus % p3.modulus, p3.modulus - 2);
+    Limb inverse23 = p3.power(p2.modulus % p3.modulus, p3.modulus - 2);
+    DoubleLimb modulus12 = static_cast<DoubleLimb>(p1.modulus) * p2.modulus;
+
+    Limb accumulator[3] = {0, 0, 0};
+    auto accumulate = [&accumulator](DoubleLimb value, size_t position) {
+      Limb carry = 0;
+      for (size_t index = position; index < 3; ++index) {
+        DoubleLimb sum = static_cast<DoubleLimb>(accumulator[index]) + carry;
+        if (index - position < 2)
+          sum += static_cast<Limb>(value >> (limbBits * (index - position)));
+        accumulator[index] = static_cast<Limb>(sum);
+        carry = static_cast<Limb>(sum >> limbBits);
+      }
+    };
+    for (size_t index = 0; index < outputSize; ++index) {
+      Limb v1 = residues[index];
+      Limb v2 = multiplyModulo(
+          (residues[size + index] + p2.modulus - v1 % p2.modulus) %
+              p2.modulus,
+          inverse12, p2.modulus);
+      Limb v3 = multiplyModulo(
+          (residues[2 * size + index] + p3.modulus - v1 % p3.modulus) %
+              p3.modulus,
+          inverse13, p3.modulus);
+      v3 = multiplyModulo((v3 + p3.modulus - v2 % p3.modulus) % p3.modulus,
+                          inverse23, p3.modulus);
+      accumulate(static_cast<DoubleLimb>(p1.modulus) * v2 + v1, 0);
+      accumulate(static_cast<DoubleLimb>(static_cast<Limb>(modulus12)) * v3,
+                 0);
+      accumulate(static_cast<DoubleLimb>(static_cast<Limb>(modulus12 >>
+                                                           limbBits)) *
+                     v3,
+                 1);
+      Limb word = accumulator[0] & 0xffffffffULL;
+      if (index % 2 == 0)
+        result[index / 2] = word;
+      else
+        result[index / 2] |= word << 32;
+      accumulator[0] = (accumulator[0] >> 32) | (accumulator[1] << 32);
+      accumulator[1] = (accumulator[1] >> 32) | (accumulator[2] << 32);
+      accumulator[2] >>= 32;
+    }
+  }
+
+  static void multiplyLimbs(Limb *result, const Limb *first, size_t firstSize,
+                            const Limb *second, size_t secondSize) {
+    PROFILE_KERNEL("multiply", (firstSize + secondSize) * sizeof(Limb));
+    if (firstSize < secondSize) {
+      std::swap(first, second);
+      std::swap(firstSize, secondSize);
+    }
+    bool squaring = first == second && firstSize == secondSize;
+    if (secondSize == 0)
+      std::fill(result, result + firstSize, 0);
+    else if (secondSize < multiplicationThresholds.karatsuba)
+      squaring ? squareBasecase(result, first, firstSize)
+               : multiplyBasecase(result, first, firstSize, second,
+                                  secondSize);
+    else if (secondSize >= multiplicationThresholds.numberTheoretic)
+      multiplyNumberTheoretic(result, first, firstSize, second, secondSize);
+    else if (firstSize >= 2 * secondSize)
+      multiplyUnbalanced(result, first, firstSize, second, secondSize);
+    else if (secondSize >= multiplicationThresholds.toomCook)
+      multiplyToomCook3(result, first, firstSize, second, secondSize);
+    else
+      multiplyKaratsuba(result, first, firstSize, second, secondSize);
+  }
+
+  void multiplyAddLimb(Limb multiplier, Limb addend) {
+    Limb carry = addend;
+    for (Limb &limb : limbs) {
+      DoubleLimb product = static_cast<DoubleLimb>(limb) * multiplier + carry;
+      limb = static_cast<Limb>(product);
+      carry = static_cast<Limb>(product >> limbBits);
+    }
+    if (carry)
+      limbs.push_back(carry);
+  }
+
+  Limb divideByLimb(Limb divisor) {
+    DoubleLimb remainder = 0;
+    for (size_t index = limbs.size(); index > 0; --index) {
+      DoubleLimb current = (remainder << limbBits) | limbs[index - 1];
+      limbs[index - 1] = static_cast<Limb>(current / divisor);
+      remainder = current % divisor;
+    }
+    removeLeadingZeros();
+    return static_cast<Limb>(remainder);
+  }
+
+  static constexpr auto decimalPowerTable = [] {
+    constexpr size_t largest = size_t(1) << (tabulatedDecimalLevels - 1);
+    std::array<Limb, 2 * largest - 1> table{};
+    FixedInteger<largest> power(10000000000000000000_big);
+    for (size_t level = 0; level < tabulatedDecimalLevels; ++level) {
+      if (level > 0)
+        power = power * power;
+      std::copy(power.data(), power.data() + power.size(),
+                table.begin() + (size_t(1) << level) - 1);
+    }
+    return table;
+  }();
+
+  static const Integer &decimalPower(size_t level) {
+    static const std::array<Integer, tabulatedDecimalLevels> table = [] {
+      std::array<Integer, tabulatedDecimalLevels> powers;
+      for (size_t index = 0; index < powers.size(); ++index)
+        powers[index] =
+            fromLimbs(decimalPowerTable.data() + (size_t(1) << index) - 1,
+                      size_t(1) << index);
+      return powers;
+    }();
+    if (level < table.size())
+      return table[level];
+    static std::deque<Integer> powers;
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (powers.empty())
+      powers.push_back(square(table.back()));
+    while (powers.size() <= level - table.size())
+      powers.push_back(square(powers.back()));
+    return powers[level - table.size()];
+  }
+
+  static Integer parseDecimal(const char *digits, size_t length) {
+    Integer result;
+    if (length <= radixConversionThreshold * decimalChunkDigits) {
+      result.limbs.reserve(length / decimalChunkDigits + 1);
+      size_t chunkLength = length % decimalChunkDigits;
+      if (chunkLength == 0)
+        chunkLength = decimalChunkDigits;
+      for (size_t start = 0; start < length; start += chunkLength,
+                  chunkLength = decimalChunkDigits) {
+        Limb chunk = 0, scale = 1;
+        for (size_t index = start; index < start + chunkLength; ++index) {
+          chunk = chunk * 10 + static_cast<Limb>(digits[index] - '0');
+          scale *= 10;
+        }
+        result.multiplyAddLimb(scale, chunk);
+      }
+      result.removeLeadingZeros();
+      return result;
+    }
+    checkCancellation();
+    size_t level = 0;
+    while ((static_cast<size_t>(decimalChunkDigits) << (level + 1)) < length)
+      ++level;
+    size_t lowLength = static_cast<size_t>(decimalChunkDigits) << level;
+    result = parseDecimal(digits, length - lowLength) * decimalPower(level);
+    return result + parseDecimal(digits + length - lowLength, lowLength);
+  }
+
+  static void writeDecimal(const Integer &value, char *output, size_t width) {
+    checkCancellation();
+    if (value.limbs.size() <= radixConversionThreshold) {
+      Integer rest = value;
+      char *cursor = output + width;
+      while (!rest.limbs.empty()) {
+        Limb chunk = rest.divideByLimb(decimalChunk);
+        for (int digit = 0; digit < decimalChunkDigits && cursor > output;
+             ++digit, chunk /= 10)
+          *--cursor = static_cast<char>('0' + chunk % 10);
+      }
+      std::fill(output, cursor, '0');
+      return;
+    }
+    size_t level = 0;
+    while ((static_cast<size_t>(decimalChunkDigits) << (level + 1)) < width)
+      ++level;
+    size_t lowWidth = static_cast<size_t>(decimalChunkDigits) << level;
+    Integer quotient, remainder;
+    divideAbsolute(value, decimalPower(level), quotient, remainder);
+    writeDecimal(quotient, output, width - lowWidth);
+    writeDecimal(remainder, output + width - lowWidth, lowWidth);
+  }
+
+  Limb moduloLimb(Limb divisor) const {
+    DoubleLimb remainder = 0;
+    for (size_t index = limbs.size(); index > 0; --index)
+      remainder = ((remainder << limbBits) | limbs[index - 1]) % divisor;
+    return static_cast<Limb>(remainder);
+  }
+
+  Integer shiftedLeft(size_t bits) const {
+    if (limbs.empty())
+      return *this;
+    size_t limbShift = bits / limbBits, bitShift = bits % limbBits;
+    Integer result;
+    result.negative = negative;
+    result.limbs.assign(limbShift + limbs.size() + 1, 0);
+    for (size_t index = 0; index < limbs.size(); ++index) {
+      result.limbs[limbShift + index] |= limbs[index] << bitShift;
+      if (bitShift)
+        result.limbs[limbShift + index + 1] =
+            limbs[index] >> (limbBits - bitShift);
+    }
+    result.removeLeadingZeros();
+    return result;
+  }
+
+  Integer shiftedRight(size_t bits) const {
+    size_t limbShift = bits / limbBits, bitShift = bits % limbBits;
+    if (limbShift >= limbs.size())
+      return Integer();
+    Integer result;
+    result.negative = negative;
+    result.limbs.assign(limbs.begin() + limbShift, limbs.end());
+    if (bitShift) {
+      for (size_t index = 0; index + 1 < result.limbs.size(); ++index)
+        result.limbs[index] =
+            (result.limbs[index] >> bitShift) |
+            (result.limbs[index + 1] << (limbBits - bitShift));
+      result.limbs.back() >>= bitShift;
+    }
+    result.removeLeadingZeros();
+    return result;
+  }
+
+  Integer lowLimbs(size_t count) const {
+    return fromLimbs(limbs.data(), std::min(count, limbs.size()));
+  }
+
+  Integer highLimbs(size_t from) const {
+    if (from >= limbs.size())
+      return Integer();
+    return fromLimbs(limbs.data() + from, limbs.size() - from);
+  }
+
+  static void divideKnuth(const Integer &dividend, const Integer &divisor,
+                          Integer &quotient, Integer &remainder) {
+    checkCancellation();
+    size_t divisorSize = divisor.limbs.size();
+    size_t quotientSize = dividend.limbs.size() - divisorSize + 1;
+    int shift = __builtin_clzll(divisor.limbs.back());
+    Scratch normalizedDivisor(divisorSize);
+    Scratch numerator(dividend.limbs.size() + 1, 0);
+    for (size_t index = divisorSize; index > 0; --index)
+      normalizedDivisor[index - 1] =
+          (divisor.limbs[index - 1] << shift) |
+          (shift && index > 1 ? divisor.limbs[index - 2] >> (limbBits - shift)
+                              : 0);
+    for (size_t index = dividend.limbs.size(); index > 0; --index) {
+      numerator[index] |= shift ? dividend.limbs[index - 1] >>
+                                      (limbBits - shift)
+                                : 0;
+      numerator[index - 1] = dividend.limbs[index - 1] << shift;
+    }
+
+    quotient.limbs.assign(quotientSize, 0);
+    quotient.negative = remainder.negative = false;
+    Limb top = normalizedDivisor[divisorSize - 1];
+    Limb next = normalizedDivisor[divisorSize - 2];
+    for (size_t position = quotientSize; position > 0; --position) {
+      Limb *window = numerator.data() + position - 1;
+      DoubleLimb current =
+          (static_cast<DoubleLimb>(window[divisorSize]) << limbBits) |
+          window[divisorSize - 1];
+      DoubleLimb estimate, rest;
+      if (window[divisorSize] >= top) {
+        estimate = ~Limb(0);
+        rest = current - estimate * top;
+      } else {
+        estimate = current / top;
+        rest = current % top;
+      }
+      while ((rest >> limbBits) == 0 &&
+             estimate * next >
+                 ((rest << limbBits) | window[divisorSize - 2])) {
+        --estimate;
+        rest += top;
+      }
+
+      Limb carry = 0, borrow = 0;
+      for (size_t index = 0; index < divisorSize; ++index) {
+        DoubleLimb product = estimate * normalizedDivisor[index] + carry;
+        carry = static_cast<Limb>(product >> limbBits);
+        DoubleLimb difference = static_cast<DoubleLimb>(window[index]) -
+                                static_cast<Limb>(product) - borrow;
+        window[index] = static_cast<Limb>(difference);
+        borrow = static_cast<Limb>(difference >> limbBits) & 1;
+      }
+      DoubleLimb difference =
+          static_cast<DoubleLimb>(window[divisorSize]) - carry - borrow;
+      window[divisorSize] = static_cast<Limb>(difference);
+      if ((difference >> limbBits) & 1) {
+        --estimate;
+        window[divisorSize] += addLimbs(window, divisorSize,
+                                        normalizedDivisor.data(), divisorSize);
+      }
+      quotient.limbs[position - 1] = static_cast<Limb>(estimate);
+    }
+
+    remainder.limbs.assign(numerator.data(), numerator.data() + divisorSize);
+    remainder.removeLeadingZeros();
+    remainder >>= shift;
+    quotient.removeLeadingZeros();
+  }
+
+  static void divideMagnitudes(const Integer &dividend, const Integer &divisor,
+                               Integer &quotient, Integer &remainder) {
+    if (compareAbsolute(dividend, divisor) < 0) {
+      quotient = Integer();
+      remainder = dividend.absolute();
+    } else if (divisor.limbs.size() == 1) {
+      quotient = dividend.absolute();
+      remainder = Integer();
+      Limb rest = quotient.divideByLimb(divisor.limbs[0]);
+      if (rest != 0)
+        remainder.limbs.push_back(rest);
+    } else {
+      divideKnuth(dividend, divisor, quotient, remainder);
+    }
+  }
+
+  static void divideTwoByOne(const Integer &dividend, const Integer &divisor,
+                             size_t size, Integer &quotient,
+                             Integer &remainder) {
+    checkCancellation();
+    if (size % 2 || size < burnikelZieglerThreshold) {
+      divideMagnitudes(dividend, divisor, quotient, remainder);
+      return;
+    }
+    size_t half = size / 2;
+    Integer highQuotient, partial;
+    divideThreeByTwo(dividend.highLimbs(half), divisor, half, highQuotient,
+                     partial);
+    partial <<= half * limbBits;
+    partial += dividend.lowLimbs(half);
+    divideThreeByTwo(partial, divisor, half, quotient, remainder);
+    highQuotient <<= half * limbBits;
+    quotient += highQuotient;
+  }
+
+  static void divideThreeByTwo(const Integer &dividend, const Integer &divisor,
+                               size_t half, Integer &quotient,
+                               Integer &remainder) {
+    Integer divisorHigh = divisor.highLimbs(half);
+    Integer dividendHigh = dividend.highLimbs(half);
+    Integer partial;
+    if (compareAbsolute(dividend.highLimbs(2 * half), divisorHigh) < 0) {
+      divideTwoByOne(dividendHigh, divisorHigh, half, quotient, partial);
+    } else {
+      quotient = Integer(1LL) << half * limbBits;
+      quotient -= Integer(1LL);
+      partial = dividendHigh - divisorHigh.shiftedLeft(half * limbBits);
+      partial += divisorHigh;
+    }
+    remainder = std::move(partial) << half * limbBits;
+    remainder += dividend.lowLimbs(half);
+    submul(remainder, quotient, divisor.lowLimbs(half));
+    while (remainder.isNegative()) {
+      quotient -= Integer(1LL);
+      remainder += divisor;
+    }
+  }
+
+  static void divideAbsolute(const Integer &dividend, const Integer &divisor,
+                             Integer &quotient, Integer &remainder) {
+    PROFILE_KERNEL("divide", (dividend.limbs.size() + divisor.limbs.size()) *
+                                 sizeof(Limb));
+    if (divisor.limbs.size() >= burnikelZieglerThreshold &&
+        dividend.limbs.size() >=
+            divisor.limbs.size() + burnikelZieglerThreshold)
+      divideBurnikelZiegler(dividend, divisor, quotient, remainder);
+    else
+      divideMagnitudes(dividend, divisor, quotient, remainder);
   }
 
-  static int compareAbsolute(const Integer &first, const Integer &second) {
-    if (first.digits.size() != second.digits.size())
-      return first.digits.size() < second.digits.size() ? -1 : 1;
-    for (int index = static_cast<int>(first.digits.size()) - 1; index >= 0;
-         --index)
-      if (first.digits[index] != second.digits[index])
-        return first.digits[index] < second.digits[index] ? -1 : 1;
-    return 0;
+  Limb bitsAt(size_t position) const {
+    size_t limbIndex = position / limbBits, bitShift = position % limbBits;
+    if (limbIndex >= limbs.size())
+      return 0;
+    Limb bits = limbs[limbIndex] >> bitShift;
+    if (bitShift && limbIndex + 1 < limbs.size())
+      bits |= limbs[limbIndex + 1] << (limbBits - bitShift);
+    return bits;
+  }
+
+  static Limb binaryGcd(Limb first, Limb second) {
+    if (first == 0 || second == 0)
+      return first | second;
+    int shift = __builtin_ctzll(first | second);
+    first >>= __builtin_ctzll(first);
+    while (second) {
+      second >>= __builtin_ctzll(second);
+      if (first > second)
+        std::swap(first, second);
+      second -= first;
+    }
+    return first << shift;
   }
 
-  static Integer addAbsolute(const Integer &first, const Integer &second) {
+  static Integer lehmerGcd(Integer larger, Integer smaller,
+                           Integer *cofactor = nullptr,
+                           Integer *finalCofactor = nullptr) {
+    PROFILE_KERNEL("gcd", (larger.limbs.size() + smaller.limbs.size()) *
+                              sizeof(Limb));
+    Integer current(1LL), next, first, second;
+    auto combine = [](Integer &target, const Integer &left, __int128 leftFactor,
+                      const Integer &right, __int128 rightFactor) {
+      target.limbs.clear();
+      target.negative = false;
+      target.accumulateMultiple(
+          left, static_cast<Limb>(leftFactor < 0 ? -leftFactor : leftFactor),
+          leftFactor < 0 ? !left.negative : left.negative);
+      target.accumulateMultiple(
+          right,
+          static_cast<Limb>(rightFactor < 0 ? -rightFactor : rightFactor),
+          rightFactor < 0 ? !right.negative : right.negative);
+    };
+    while (smaller.limbs.size() > 1) {
+      checkCancellation();
+      size_t shift = larger.bitLength() - limbBits;
+      __int128 high = larger.bitsAt(shift), low = smaller.bitsAt(shift);
+      __int128 a = 1, b = 0, c = 0, d = 1;
+      while (low + c != 0 && low + d != 0) {
+        __int128 quotient = (high + a) / (low + c);
+        if (quotient != (high + b) / (low + d))
+          break;
+        __int128 temporary = a - quotient * c;
+        a = c;
+        c = temporary;
+        temporary = b - quotient * d;
+        b = d;
+        d = temporary;
+        temporary = high - quotient * low;
+        high = low;
+        low = temporary;
+      }
+      if (b == 0) {
+        Integer quotient, remainder;
+        divideAbsolute(larger, smaller, quotient, remainder);
+        larger = std::move(smaller);
+        smaller = std::move(remainder);
+        if (cofactor) {
+          submul(current, quotient, next);
+          std::swap(current, next);
+        }
+        continue;
+      }
+      combine(first, larger, a, smaller, b);
+      combine(second, larger, c, smaller, d);
+      std::swap(larger, first);
+      std::swap(smaller, second);
+      if (cofactor) {
+        combine(first, current, a, next, b);
+        combine(second, current, c, next, d);
+        std::swap(current, first);
+        std::swap(next, second);
+      }
+    }
+    while (cofactor && !smaller.isZero()) {
+      checkCancellation();
+      Integer quotient, remainder;
+      divideAbsolute(larger, smaller, quotient, remainder);
+      larger = std::move(smaller);
+      smaller = std::move(remainder);
+      submul(current, quotient, next);
+      std::swap(current, next);
+    }
+    if (cofactor) {
+      *cofactor = std::move(current);
+      if (finalCofactor)
+        *finalCofactor = std::move(next);
+      return larger;
+    }
+    if (smaller.isZero())
+      return larger;
+    Integer quotient, remainder;
+    divideAbsolute(larger, smaller, quotient, remainder);
     Integer result;
-    result.digits.resize(
-        std::max(first.digits.size(), second.digits.size()) + 1, 0);
-    int carry = 0;
-    for (size_t index = 0; index < result.digits.size(); ++index) {
-      int sum = carry;
-      if (index < first.digits.size())
-        sum += first.digits[index];
-      if (index < second.digits.size())
-        sum += second.digits[index];
-      result.digits[index] = sum % 10;
-      carry = sum / 10;
+    result.limbs.push_back(binaryGcd(
+        smaller.limbs[0], remainder.isZero() ? 0 : remainder.limbs[0]));
+    return result;
+  }
+
+  static Integer exponentiate(const Integer &base, std::uint64_t exponent) {
+    Integer result(1LL), current = base;
+    while (exponent > 0) {
+      checkCancellation();
+      bool multiply = exponent & 1;
+      exponent >>= 1;
+      if (multiply && exponent > 0 &&
+          current.limbs.size() >= parallelThreshold) {
+        Integer squared;
+        parallelFor(2, true, [&](size_t part) {
+          if (part)
+            squared = square(current);
+          else
+            result *= current;
+        });
+        current = std::move(squared);
+        continue;
+      }
+      if (multiply)
+        result *= current;
+      if (exponent > 0)
+        current *= current;
+    }
+    return result;
+  }
+
+  static Integer root(const Integer &value, std::uint64_t degree) {
+    size_t bits = value.bitLength();
+    size_t rootBits = (bits + degree - 1) / degree;
+    Integer estimate;
+    if (rootBits > limbBits) {
+      size_t shift = rootBits / 2;
+      estimate = root(value >> (degree * shift), degree);
+      estimate += Integer(1LL);
+      estimate <<= shift;
+    } else {
+      estimate = Integer(1LL) << rootBits;
+    }
+    Integer multiplier(static_cast<long long>(degree - 1));
+    for (;;) {
+      checkCancellation();
+      Integer next = value / exponentiate(estimate, degree - 1);
+      addmul(next, estimate, multiplier);
+      next.divideByLimb(degree);
+      if (next >= estimate)
+        return estimate;
+      estimate = std::move(next);
+    }
+  }
+
+  static Limb adicRoot(Limb value, Limb degree) {
+    Limb inverse = degree;
+    for (int step = 0; step < 6; ++step)
+      inverse *= 2 - degree * inverse;
+    Limb result = 1;
+    for (; inverse; inverse >>= 1) {
+      if (inverse & 1)
+        result *= value;
+      value *= value;
     }
-    result.removeLeadingZeros();
     return result;
   }
 
-  static Integer subtractAbsolute(const Integer &first, const Integer &second) {
+  static bool hasRoot(const Integer &odd, Limb degree) {
+    if (degree == 2)
+      return square(root(odd, 2)) == odd;
+    Limb candidate = adicRoot(odd.limbs[0], degree);
+    size_t rootBits = (odd.bitLength() + degree - 1) / degree;
     Integer result;
-    result.digits.resize(first.digits.size(), 0);
-    int borrow = 0;
-    for (size_t index = 0; index < first.digits.size(); ++index) {
-      int value = first.digits[index] - borrow -
-                  (index < second.digits.size() ? second.digits[index] : 0);
-      if (value < 0) {
-        value += 10;
-        borrow = 1;
-      } else
-        borrow = 0;
-      result.digits[index] = value;
+    if (rootBits <= limbBits) {
+      if (static_cast<size_t>(limbBits - __builtin_clzll(candidate)) !=
+          rootBits)
+        return false;
+      result = fromLimbs(&candidate, 1);
+    } else {
+      result = root(odd, degree);
+      if (result.limbs[0] != candidate)
+        return false;
     }
-    result.removeLeadingZeros();
+    return exponentiate(result, degree) == odd;
+  }
+
+  template <typename Combine>
+  static Integer reduceBalanced(const Integer *values, size_t count,
+                                size_t limbs, const Combine &combine) {
+    checkCancellation();
+    if (count <= 8) {
+      Integer result = values[0];
+      for (size_t index = 1; index < count; ++index)
+        combine(result, values[index]);
+      return result;
+    }
+    size_t middle = count / 2;
+    std::array<Integer, 2> halves;
+    parallelFor(2, limbs >= 2 * parallelThreshold, [&](size_t part) {
+      halves[part] =
+          part ? reduceBalanced(values + middle, count - middle,
+                                limbs - limbs * middle / count, combine)
+               : reduceBalanced(values, middle, limbs * middle / count,
+                                combine);
+    });
+    combine(halves[0], halves[1]);
+    return std::move(halves[0]);
+  }
+
+  template <typename Combine>
+  static Integer reduceBalanced(std::span<const Integer> values,
+                                const Combine &combine) {
+    size_t limbs = 0;
+    for (const Integer &value : values)
+      limbs += value.limbs.size();
+    return reduceBalanced(values.data(), values.size(), limbs, combine);
+  }
+
+  static Integer oddProduct(Limb low, Limb high) {
+    checkCancellation();
+    Limb first = low + 1 + (low & 1);
+    Limb count = high >= first ? (high - first) / 2 + 1 : 0;
+    if (count > 16) {
+      Limb middle = first - 1 + 2 * (count / 2);
+      size_t estimatedSize =
+          count * static_cast<size_t>(limbBits - __builtin_clzll(high)) /
+          limbBits;
+      std::array<Integer, 2> halves;
+      parallelFor(2, estimatedSize >= 2 * parallelThreshold,
+                  [&](size_t part) {
+                    halves[part] = part ? oddProduct(middle, high)
+                                        : oddProduct(low, middle);
+                  });
+      return std::move(halves[0]) * halves[1];
+    }
+    Integer result(1LL);
+    Limb packed = 1;
+    for (Limb factor = first; factor <= high; factor += 2) {
+      if (packed > ~Limb(0) / factor) {
+        result.multiplyAddLimb(packed, 0);
+        packed = 1;
+      }
+      packed *= factor;
+    }
+    result.multiplyAddLimb(packed, 0);
     return result;
   }
 
+  static void divideBurnikelZiegler(const Integer &dividend,
+                                    const Integer &divisor, Integer &quotient,
+                                    Integer &remainder) {
+    size_t blockSize = 1;
+    while (blockSize * burnikelZieglerThreshold <= divisor.limbs.size())
+      blockSize *= 2;
+    size_t size = (divisor.limbs.size() + blockSize - 1) / blockSize *
+                  blockSize;
+    size_t shift = size * limbBits - divisor.bitLength();
+    Integer normalizedDivisor = divisor.shiftedLeft(shift);
+    Integer normalizedDividend = dividend.shiftedLeft(shift);
+    normalizedDivisor.negative = normalizedDividend.negative = false;
+    size_t blocks = std::max<size_t>(
+        2, (normalizedDividend.bitLength() + 1 + size * limbBits - 1) /
+               (size * limbBits));
+
+    Integer current = normalizedDividend.highLimbs((blocks - 2) * size);
+    quotient = Integer();
+    for (size_t block = blocks - 1; block > 0; --block) {
+      Integer blockQuotient;
+      divideTwoByOne(current, normalizedDivisor, size, blockQuotient,
+                     remainder);
+      quotient <<= size * limbBits;
+      quotient += blockQuotient;
+      if (block > 1) {
+        current = remainder.shiftedLeft(size * limbBits);
+        current += normalizedDividend.highLimbs((block - 2) * size)
+                       .lowLimbs(size);
+      }
+    }
+    remainder >>= shift;
+  }
+
 public:
-  Integer() : digits(1, 0), negative(false) {}
+  Integer() : negative(false) {}
+
+  template <size_t Capacity>
+  Integer(const FixedInteger<Capacity> &value)
+      : negative(value.isNegative()) {
+    limbs.assign(value.data(), value.data() + value.size());
+  }
 
   Integer(long long value) : negative(value < 0) {
     unsigned long long absolute =
         (value < 0) ? static_cast<unsigned long long>(-(value + 1)) + 1
                     : static_cast<unsigned long long>(value);
-    if (absolute == 0) {
-      digits.push_back(0);
-      return;
-    }
-    while (absolute) {
-      digits.push_back(absolute % 10);
-      absolute /= 10;
-    }
+    if (absolute != 0)
+      limbs.push_back(absolute);
   }
 
-  Integer(const std::string &text) : negative(false) {
-    if (text.empty()) {
-      digits.push_back(0);
+  Integer(std::string_view text) : negative(false) {
+    if (text.empty())
       return;
-    }
     size_t start = 0;
     if (text[0] == '-') {
       negative = true;
@@ -92,46 +1701,212 @@ public:
     } else if (text[0] == '+') {
       start = 1;
     }
-    while (start < text.size() - 1 && text[start] == '0')
-      ++start;
-    for (size_t index = text.size(); index > start; --index) {
-      char character = text[index - 1];
-      if (character < '0' || character > '9')
+    for (size_t index = start; index < text.size(); ++index)
+      if (text[index] < '0' || text[index] > '9')
         throw std::invalid_argument("Invalid character in Integer");
-      digits.push_back(character - '0');
-    }
-    if (digits.empty())
-      digits.push_back(0);
+    while (start < text.size() && text[start] == '0')
+      ++start;
+    PROFILE_KERNEL("parse", text.size() - start);
+    limbs = parseDecimal(text.data() + start, text.size() - start).limbs;
     removeLeadingZeros();
   }
 
+  void toString(std::string &output) const {
+    if (limbs.empty()) {
+      output.assign(1, '0');
+      return;
+    }
+    if (limbs.size() == 1) {
+      char buffer[24];
+      char *end = std::to_chars(buffer, buffer + sizeof(buffer), limbs[0]).ptr;
+      output.assign(negative ? "-" : "");
+      output.append(buffer, end);
+      return;
+    }
+    PROFILE_KERNEL("toString", limbs.size() * sizeof(Limb));
+    size_t sign = negative ? 1 : 0;
+    size_t width =
+        static_cast<size_t>(static_cast<double>(bitLength()) * 0.30102999566) +
+        1;
+    output.assign(sign + width, '0');
+    writeDecimal(*this, output.data() + sign, width);
+    output.erase(sign, output.find_first_not_of('0', sign) - sign);
+    if (negative)
+      output[0] = '-';
+  }
+
   std::string toString() const {
     std::string result;
-    if (negative)
-      result += '-';
-    for (int index = static_cast<int>(digits.size()) - 1; index >= 0; --index)
-      result += static_cast<char>('0' + digits[index]);
+    toString(result);
+    return result;
+  }
+
+  void save(const std::string &path) const {
+    PROFILE_SCOPE("save", limbs.size() * sizeof(Limb));
+    char header[fileHeaderLimbs * sizeof(Limb)] = {};
+    std::copy(fileMagic, fileMagic + sizeof(fileMagic), header);
+    storeLittle(header + 8, fileVersion, 4);
+    storeLittle(header + 12, negative, 4);
+    storeLittle(header + 16, limbs.size(), 8);
+    std::string temporary = path + ".tmp";
+    bool written;
+    {
+      std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+      output.write(header, sizeof(header));
+      if constexpr (std::endian::native == std::endian::little) {
+        output.write(reinterpret_cast<const char *>(limbs.data()),
+                     static_cast<std::streamsize>(limbs.size() * sizeof(Limb)));
+      } else {
+        for (Limb limb : limbs) {
+          Limb swapped = __builtin_bswap64(limb);
+          output.write(reinterpret_cast<const char *>(&swapped),
+                       sizeof(swapped));
+        }
+      }
+      written = static_cast<bool>(output.flush());
+    }
+    if (!written || std::rename(temporary.c_str(), path.c_str()) != 0) {
+      std::remove(temporary.c_str());
+      throw std::runtime_error("Cannot write " + path);
+    }
+  }
+
+  static Integer load(const std::string &path) {
+    PROFILE_SCOPE("load", 0);
+    std::ifstream input(path, std::ios::binary | std::ios::ate);
+    if (!input)
+      throw std::runtime_error("Cannot open " + path);
+    std::uint64_t fileSize = static_cast<std::uint64_t>(input.tellg());
+    input.seekg(0);
+    char header[fileHeaderLimbs * sizeof(Limb)];
+    if (!input.read(header, sizeof(header)) ||
+        !std::equal(fileMagic, fileMagic + sizeof(fileMagic), header))
+      throw std::runtime_error("Not an Integer file: " + path);
+    if (loadLittle(header + 8, 4) != fileVersion)
+      throw std::runtime_error("Unsupported Integer file version: " + path);
+    std::uint64_t size = loadLittle(header + 16, 8);
+    if (size > (fileSize - sizeof(header)) / sizeof(Limb))
+      throw std::runtime_error("Truncated Integer file: " + path);
+    Integer result;
+    if (!mapLimbs(path, size, result.limbs)) {
+      result.limbs.resizeUninitialized(size);
+      input.read(reinterpret_cast<char *>(result.limbs.data()),
+                 static_cast<std::streamsize>(size * sizeof(Limb)));
+      if (!input)
+        throw std::runtime_error("Truncated Integer file: " + path);
+      if constexpr (std::endian::native == std::endian::big)
+        for (Limb &limb : result.limbs)
+          limb = __builtin_bswap64(limb);
+    }
+    result.negative = loadLittle(header + 12, 4) & 1;
+    result.removeLeadingZeros();
     return result;
   }
 
-  bool isZero() const { return digits.size() == 1 && digits[0] == 0; }
+  bool isZero() const { return limbs.empty(); }
   bool isNegative() const { return negative; }
 
-  Integer operator-() const {
+  bool fitsInt64() const {
+    return limbs.empty() ||
+           (limbs.size() == 1 &&
+            limbs[0] <= static_cast<Limb>(
+                            std::numeric_limits<std::int64_t>::max()) +
+                            negative);
+  }
+
+  std::int64_t toInt64() const {
+    if (!fitsInt64())
+      throw std::out_of_range("Integer does not fit in 64 bits");
+    if (limbs.empty())
+      return 0;
+    return static_cast<std::int64_t>(negative ? 0 - limbs[0] : limbs[0]);
+  }
+
+  size_t bitLength() const {
+    if (limbs.empty())
+      return 0;
+    return (limbs.size() - 1) * limbBits + limbBits -
+           static_cast<size_t>(__builtin_clzll(limbs.back()));
+  }
+
+  bool testBit(size_t index) const {
+    size_t limbIndex = index / limbBits;
+    return limbIndex < limbs.size() &&
+           ((limbs[limbIndex] >> (index % limbBits)) & 1);
+  }
+
+  Magnitude magnitude() const { return Magnitude(*this); }
+
+  Integer &operator<<=(size_t bits) {
+    if (limbs.empty())
+      return *this;
+    size_t limbShift = bits / limbBits, bitShift = bits % limbBits;
+    size_t size = limbs.size();
+    limbs.resize(size + limbShift + 1, 0);
+    for (size_t index = size; index > 0; --index) {
+      Limb limb = limbs[index - 1];
+      if (bitShift)
+        limbs[index + limbShift] |= limb >> (limbBits - bitShift);
+      limbs[index - 1 + limbShift] = limb << bitShift;
+    }
+    std::fill(limbs.begin(), limbs.begin() + limbShift, 0);
+    removeLeadingZeros();
+    return *this;
+  }
+
+  Integer &operator>>=(size_t bits) {
+    size_t limbShift = bits / limbBits, bitShift = bits % limbBits;
+    if (limbShift >= limbs.size()) {
+      limbs.clear();
+      negative = false;
+      return *this;
+    }
+    limbs.erase(limbs.begin(), limbs.begin() + limbShift);
+    if (bitShift) {
+      for (size_t index = 0; index + 1 < limbs.size(); ++index)
+        limbs[index] = (limbs[index] >> bitShift) |
+                       (limbs[index + 1] << (limbBits - bitShift));
+      limbs.back() >>= bitShift;
+    }
+    removeLeadingZeros();
+    return *this;
+  }
+
+  Integer operator<<(size_t bits) const & { return shiftedLeft(bits); }
+  Integer operator<<(size_t bits) && {
+    *this <<= bits;
+    return std::move(*this);
+  }
+  Integer operator>>(size_t bits) const & { return shiftedRight(bits); }
+  Integer operator>>(size_t bits) && {
+    *this >>= bits;
+    return std::move(*this);
+  }
+
+  Integer operator-() const & {
     Integer result = *this;
     if (!result.isZero())
       result.negative = !result.negative;
     return result;
   }
+  Integer operator-() && {
+    if (!isZero())
+      negative = !negative;
+    return std::move(*this);
+  }
 
-  Integer absolute() const {
+  Integer absolute() const & {
     Integer result = *this;
     result.negative = false;
     return result;
   }
+  Integer absolute() && {
+    negative = false;
+    return std::move(*this);
+  }
 
   bool operator==(const Integer &other) const {
-    return negative == other.negative && digits == other.digits;
+    return negative == other.negative && limbs == other.limbs;
   }
   bool operator!=(const Integer &other) const { return !(*this == other); }
   bool operator<(const Integer &other) const {
@@ -144,49 +1919,95 @@ public:
   bool operator<=(const Integer &other) const { return !(other < *this); }
   bool operator>=(const Integer &other) const { return !(*this < other); }
 
-  Integer operator+(const Integer &other) const {
-    if (negative == other.negative) {
-      Integer result = addAbsolute(*this, other);
-      result.negative = negative;
-      result.removeLeadingZeros();
-      return result;
-    }
-    int comparison = compareAbsolute(*this, other);
-    if (comparison == 0)
-      return Integer(0LL);
-    if (comparison > 0) {
-      Integer result = subtractAbsolute(*this, other);
-      result.negative = negative;
-      result.removeLeadingZeros();
-      return result;
+  Integer &operator+=(const Integer &other) {
+    accumulate(other.limbs.data(), other.limbs.size(), other.negative);
+    return *this;
+  }
+
+  Integer &operator-=(const Integer &other) {
+    accumulate(other.limbs.data(), other.limbs.size(), !other.negative);
+    return *this;
+  }
+
+  Integer &operator*=(const Integer &other) {
+    if (multiplySmall(*this, *this, other))
+      return *this;
+    if (isZero() || other.isZero()) {
+      limbs.clear();
+      negative = false;
+      return *this;
     }
-    Integer result = subtractAbsolute(other, *this);
-    result.negative = other.negative;
-    result.removeLeadingZeros();
-    return result;
+    LimbVector product = takeSpareLimbs(limbs.size() + other.limbs.size());
+    multiplyLimbs(product.data(), limbs.data(), limbs.size(),
+                  other.limbs.data(), other.limbs.size());
+    limbs.swap(product);
+    releaseSpareLimbs(std::move(product));
+    negative = negative != other.negative;
+    removeLeadingZeros();
+    return *this;
+  }
+
+  Integer &operator/=(const Integer &other);
+  Integer &operator%=(const Integer &other);
+
+  Integer operator+(const Integer &other) const & {
+    return sum(*this, other, other.negative);
+  }
+  Integer operator+(const Integer &other) && {
+    *this += other;
+    return std::move(*this);
   }
 
-  Integer operator-(const Integer &other) const { return *this + (-other); }
+  Integer operator-(const Integer &other) const & {
+    return sum(*this, other, !other.negative);
+  }
+  Integer operator-(const Integer &other) && {
+    *this -= other;
+    return std::move(*this);
+  }
 
-  Integer operator*(const Integer &other) const {
+  Integer operator*(const Integer &other) const & {
     Integer result;
-    result.digits.resize(digits.size() + other.digits.size(), 0);
-    for (size_t i = 0; i < digits.size(); ++i) {
-      int carry = 0;
-      for (size_t j = 0; j < other.digits.size() || carry; ++j) {
-        long long current =
-            result.digits[i + j] + static_cast<long long>(carry) +
-            (j < other.digits.size()
-                 ? static_cast<long long>(digits[i]) * other.digits[j]
-                 : 0LL);
-        result.digits[i + j] = static_cast<int>(current % 10);
-        carry = static_cast<int>(current / 10);
-      }
-    }
+    if (multiplySmall(result, *this, other) || isZero() || other.isZero())
+      return result;
+    result.limbs.resize(limbs.size() + other.limbs.size());
+    multiplyLimbs(result.limbs.data(), limbs.data(), limbs.size(),
+                  other.limbs.data(), other.limbs.size());
     result.negative = negative != other.negative;
     result.removeLeadingZeros();
     return result;
   }
+  Integer operator*(const Integer &other) && {
+    *this *= other;
+    return std::move(*this);
+  }
+
+  friend void addmul(Integer &target, const Integer &first,
+                     const Integer &second);
+  friend void submul(Integer &target, const Integer &first,
+                     const Integer &second);
+
+  friend class Modulus;
+  friend class Factorizer;
+  friend class ResultCache;
+  friend class Expression;
+
+  friend Integer square(const Integer &value);
+  friend Integer power(const Integer &base, const Integer &exponent);
+
+  friend Integer gcd(const Integer &first, const Integer &second);
+  friend std::tuple<Integer, Integer, Integer>
+  extendedGcd(const Integer &first, const Integer &second);
+  friend Integer lcm(const Integer &first, const Integer &second);
+  friend Integer sum(std::span<const Integer> values);
+  friend Integer product(std::span<const Integer> values);
+  friend Integer gcd(std::span<const Integer> values);
+  friend Integer lcm(std::span<const Integer> values);
+  friend bool isPrime(const Integer &number);
+  friend Integer factorial(const Integer &number);
+  friend Integer isqrt(const Integer &number);
+  friend Integer iroot(const Integer &number, const Integer &degree);
+  friend bool isPerfectPower(const Integer &number);
 
   friend std::pair<Integer, Integer>
   divideWithRemainder(const Integer &dividend, const Integer &divisor);
@@ -204,41 +2025,61 @@ inline std::pair<Integer, Integer> divideWithRemainder(const Integer &dividend,
   if (divisor.isZero())
     throw std::domain_error("Division by zero");
 
-  Integer absoluteDividend = dividend.absolute();
-  Integer absoluteDivisor = divisor.absolute();
-  if (absoluteDividend < absoluteDivisor)
+  if (dividend.limbs.size() <= 2 && divisor.limbs.size() <= 2) {
+    Integer::DoubleLimb numerator = Integer::smallMagnitude(
+        dividend.limbs.data(), dividend.limbs.size());
+    Integer::DoubleLimb denominator =
+        Integer::smallMagnitude(divisor.limbs.data(), divisor.limbs.size());
+    Integer quotient, remainder;
+    quotient.assignSmall(numerator / denominator,
+                         dividend.isNegative() != divisor.isNegative());
+    remainder.assignSmall(numerator % denominator, dividend.isNegative());
+    return {std::move(quotient), std::move(remainder)};
+  }
+
+  if (Integer::compareAbsolute(dividend, divisor) < 0)
     return {Integer(0LL), dividend};
 
   Integer quotient, remainder;
-  quotient.digits.resize(absoluteDividend.digits.size(), 0);
-
-  for (int index = static_cast<int>(absoluteDividend.digits.size()) - 1;
-       index >= 0; --index) {
-    remainder.digits.insert(remainder.digits.begin(), 0);
-    remainder.digits[0] = absoluteDividend.digits[index];
-    remainder.removeLeadingZeros();
-
-    int low = 0, high = 9, digit = 0;
-    while (low <= high) {
-      int middle = (low + high) / 2;
-      if (absoluteDivisor * Integer(static_cast<long long>(middle)) <=
-          remainder) {
-        digit = middle;
-        low = middle + 1;
-      } else {
-        high = middle - 1;
-      }
-    }
-    quotient.digits[index] = digit;
-    remainder =
-        remainder - absoluteDivisor * Integer(static_cast<long long>(digit));
-  }
+  Integer::divideAbsolute(dividend, divisor, quotient, remainder);
 
   quotient.negative = dividend.isNegative() != divisor.isNegative();
   remainder.negative = dividend.isNegative();
   quotient.removeLeadingZeros();
   remainder.removeLeadingZeros();
-  return {quotient, remainder};
+  return {std::move(quotient), std::move(remainder)};
+}
+
+inline Integer &Integer::operator/=(const Integer &other) {
+  *this = std::move(divideWithRemainder(*this, other).first);
+  return *this;
+}
+
+inline Integer &Integer::operator%=(const Integer &other) {
+  *this = std::move(divideWithRemainder(*this, other).second);
+  return *this;
+}
+
+inline void addmul(Integer &target, const Integer &first,
+                   const Integer &second) {
+  Integer::multiplyAccumulate(target, first, second, false);
+}
+
+inline void submul(Integer &target, const Integer &first,
+                   const Integer &second) {
+  Integer::multiplyAccumulate(target, first, second, true);
+}
+
+inline Integer square(const Integer &value) {
+  if (value.isZero())
+    return Integer(0LL);
+  Integer result;
+  result.limbs.resize(2 * value.limbs.size());
+  Integer::multiplyLimbs(result.limbs.data(), value.limbs.data(),
+                         value.limbs.size(), value.limbs.data(),
+                         value.limbs.size());
+  result.removeLeadingZeros();
+  return result;
 }
 
 inline Integer power(const Integer &base, const Integer &exponent) {
@@ -246,66 +2087,534 @@ inline Integer power(const Integer &base, const Integer &exponent) {
     throw std::domain_error("Negative exponent");
   if (exponent.isZero())
     return Integer(1LL);
-  std::string exponentString = exponent.toString();
-  if (exponentString.size() > 7)
+  if (!exponent.fitsInt64() || exponent.toInt64() > 10000)
     throw std::domain_error("Exponent too large");
-  long long exponentValue = std::stoll(exponentString);
-  if (exponentValue > 10000)
-    throw std::domain_error("Exponent too large");
-  Integer result(1LL), current = base;
-  while (exponentValue > 0) {
-    if (exponentValue & 1)
-      result = result * current;
-    current = current * current;
-    exponentValue >>= 1;
-  }
-  return result;
+  return Integer::exponentiate(base, exponent.toInt64());
 }
 
+inline constexpr auto smallFactorials = [] {
+  std::array<Integer::Limb, 21> table{1};
+  for (size_t number = 1; number < table.size(); ++number)
+    table[number] = table[number - 1] * number;
+  return table;
+}();
+
 inline Integer factorial(const Integer &number) {
   if (number.isNegative())
     throw std::domain_error("Factorial of negative number");
-  std::string numberString = number.toString();
-  if (numberString.size() > 5)
-    throw std::domain_error("Number too large for factorial");
-  long long value = std::stoll(numberString);
-  if (value > 10000)
+  if (number.limbs.size() > 1 || (!number.isZero() &&
+                                  number.limbs[0] > Integer::factorialLimit))
     throw std::domain_error("Factorial argument too large");
-  Integer result(1LL);
-  for (long long i = 2; i <= value; ++i)
-    result = result * Integer(i);
+  Integer::Limb value = number.isZero() ? 0 : number.limbs[0];
+  if (value < smallFactorials.size())
+    return Integer::fromLimbs(&smallFactorials[value], 1);
+  PROFILE_SCOPE("factorial", number.limbs.size() * sizeof(Integer::Limb));
+  Integer partial(1LL), result(1LL);
+  for (size_t level = number.bitLength(); level > 0; --level) {
+    Integer::checkCancellation();
+    partial *= Integer::oddProduct(value >> level, value >> (level - 1));
+    result *= partial;
+  }
+  result <<= value - static_cast<Integer::Limb>(__builtin_popcountll(value));
   return result;
 }
 
+inline Integer isqrt(const Integer &number) {
+  if (number.isNegative())
+    throw std::domain_error("Square root of negative number");
+  if (number.isZero())
+    return Integer(0LL);
+  return Integer::root(number, 2);
+}
+
+inline Integer iroot(const Integer &number, const Integer &degree) {
+  if (degree.isNegative() || degree.isZero())
+    throw std::domain_error("Root degree must be positive");
+  if (number.isNegative()) {
+    if (!degree.testBit(0))
+      throw std::domain_error("Even root of negative number");
+    return -iroot(-number, degree);
+  }
+  if (number.isZero() || degree == Integer(1LL))
+    return number;
+  if (!degree.fitsInt64() ||
+      static_cast<std::uint64_t>(degree.toInt64()) >= number.bitLength())
+    return Integer(1LL);
+  return Integer::root(number, static_cast<std::uint64_t>(degree.toInt64()));
+}
+
+inline bool isPerfectPower(const Integer &number) {
+  if (Integer::compareAbsolute(number, Integer(1LL)) <= 0)
+    return true;
+  Integer odd = number.absolute();
+  size_t twos = 0;
+  while (!odd.testBit(twos))
+    ++twos;
+  odd >>= twos;
+  if (odd == Integer(1LL))
+    return number.isNegative() ? (twos >> __builtin_ctzll(twos)) > 1
+                               : twos > 1;
+  size_t bits = odd.bitLength();
+  std::vector<bool> composite(bits + 1, false);
+  for (size_t degree = 2; degree <= bits; ++degree) {
+    if (composite[degree])
+      continue;
+    for (size_t multiple = degree * degree; multiple <= bits;
+         multiple += degree)
+      composite[multiple] = true;
+    if (twos % degree != 0 || (degree == 2 && number.isNegative()))
+      continue;
+    Integer::checkCancellation();
+    if (Integer::hasRoot(odd, degree))
+      return true;
+  }
+  return false;
+}
+
 inline Integer gcd(const Integer &first, const Integer &second) {
-  Integer x = first.absolute(), y = second.absolute();
-  while (!y.isZero()) {
-    Integer temporary = x % y;
-    x = y;
-    y = temporary;
+  if (Integer::compareAbsolute(first, second) < 0)
+    return Integer::lehmerGcd(second.absolute(), first.absolute());
+  return Integer::lehmerGcd(first.absolute(), second.absolute());
+}
+
+inline std::tuple<Integer, Integer, Integer>
+extendedGcd(const Integer &first, const Integer &second) {
+  bool swapped = Integer::compareAbsolute(first, second) < 0;
+  const Integer &larger = swapped ? second : first;
+  const Integer &smaller = swapped ? first : second;
+  Integer largerFactor, smallerFactor;
+  Integer divisor = Integer::lehmerGcd(larger.absolute(), smaller.absolute(),
+                                       &largerFactor);
+  if (!smaller.isZero()) {
+    smallerFactor = divisor;
+    if (larger.isNegative())
+      addmul(smallerFactor, larger, largerFactor);
+    else
+      submul(smallerFactor, larger, largerFactor);
+    smallerFactor /= smaller;
   }
-  return x;
+  if (larger.isNegative())
+    largerFactor = -std::move(largerFactor);
+  if (swapped)
+    return {divisor, smallerFactor, largerFactor};
+  return {divisor, largerFactor, smallerFactor};
 }
 
 inline Integer lcm(const Integer &first, const Integer &second) {
   if (first.isZero() || second.isZero())
     return Integer(0LL);
-  return first.absolute() / gcd(first, second) * second.absolute();
+  bool swapped = Integer::compareAbsolute(first, second) < 0;
+  const Integer &larger = swapped ? second : first;
+  const Integer &smaller = swapped ? first : second;
+  Integer cofactor, finalCofactor;
+  Integer::lehmerGcd(larger.absolute(), smaller.absolute(), &cofactor,
+                     &finalCofactor);
+  return (larger * finalCofactor).absolute();
 }
 
-inline bool isPrime(const Integer &number) {
-  if (number.isNegative() || number <= Integer(1LL))
+inline Integer sum(std::span<const Integer> values) {
+  if (values.empty())
+    return Integer(0LL);
+  return Integer::reduceBalanced(
+      values, [](Integer &target, const Integer &value) { target += value; });
+}
+
+inline Integer product(std::span<const Integer> values) {
+  if (values.empty())
+    return Integer(1LL);
+  return Integer::reduceBalanced(
+      values, [](Integer &target, const Integer &value) { target *= value; });
+}
+
+inline Integer gcd(std::span<const Integer> values) {
+  if (values.empty())
+    return Integer(0LL);
+  return Integer::reduceBalanced(values,
+                                 [](Integer &target, const Integer &value) {
+                                   if (target.bitLength() != 1)
+                                     target = gcd(target, value);
+                                 })
+      .absolute();
+}
+
+inline Integer lcm(std::span<const Integer> values) {
+  if (values.empty())
+    return Integer(1LL);
+  return Integer::reduceBalanced(values,
+                                 [](Integer &target, const Integer &value) {
+                                   target = lcm(target, value);
+                                 })
+      .absolute();
+}
+
+inline constexpr unsigned smallPrimeLimit = 4096;
+
+constexpr std::pair<std::array<unsigned, smallPrimeLimit>, size_t>
+sieveSmallPrimes() {
+  std::array<bool, smallPrimeLimit> composite{};
+  std::array<unsigned, smallPrimeLimit> primes{};
+  size_t count = 0;
+  for (unsigned candidate = 2; candidate < smallPrimeLimit; ++candidate) {
+    if (composite[candidate])
+      continue;
+    primes[count++] = candidate;
+    for (unsigned multiple = candidate * candidate; multiple < smallPrimeLimit;
+         multiple += candidate)
+      composite[multiple] = true;
+  }
+  return {primes, count};
+}
+
+inline constexpr auto smallPrimes = [] {
+  constexpr auto sieved = sieveSmallPrimes();
+  std::array<unsigned, sieved.second> primes{};
+  std::copy_n(sieved.first.begin(), primes.size(), primes.begin());
+  return primes;
+}();
+
+struct SmallPrimeGroup {
+  Integer::Limb product;
+  unsigned begin;
+  unsigned end;
+};
+
+constexpr std::pair<std::array<SmallPrimeGroup, smallPrimes.size()>, size_t>
+groupSmallPrimes() {
+  std::array<SmallPrimeGroup, smallPrimes.size()> groups{};
+  size_t count = 0;
+  for (unsigned index = 0; index < smallPrimes.size(); ++count) {
+    SmallPrimeGroup group{1, index, index};
+    while (group.end < smallPrimes.size() &&
+           group.product <= ~Integer::Limb(0) / smallPrimes[group.end])
+      group.product *= smallPrimes[group.end++];
+    groups[count] = group;
+    index = group.end;
+  }
+  return {groups, count};
+}
+
+inline constexpr auto smallPrimeGroups = [] {
+  constexpr auto grouped = groupSmallPrimes();
+  std::array<SmallPrimeGroup, grouped.second> groups{};
+  std::copy_n(grouped.first.begin(), groups.size(), groups.begin());
+  return groups;
+}();
+
+class Modulus {
+public:
+  static inline size_t montgomeryMultiplicationThreshold = 160;
+
+  explicit Modulus(const Integer &number)
+      : modulus(number.absolute()), size(modulus.limbs.size()),
+        montgomeryInverse(0), montgomery(false) {
+    if (modulus.isZero())
+      throw std::domain_error("Division by zero");
+    if (size >= 2)
+      reciprocal =
+          (Integer(1LL) << (2 * Integer::limbBits * size)) / modulus;
+    if (!modulus.testBit(0) || modulus == Integer(1LL))
+      return;
+    montgomery = true;
+    Integer::Limb low = modulus.limbs[0], inverted = low;
+    for (int step = 0; step < 6; ++step)
+      inverted *= 2 - low * inverted;
+    montgomeryInverse = 0 - inverted;
+    if (size >= montgomeryMultiplicationThreshold) {
+      Integer approximation = Integer::fromLimbs(&inverted, 1);
+      for (size_t precision = 1; precision < size;) {
+        precision = std::min(2 * precision, size);
+        Integer error =
+            (modulus.lowLimbs(precision) * approximation).lowLimbs(precision);
+        error -= Integer(1LL);
+        approximation -= (approximation * error).lowLimbs(precision);
+        if (approximation.isNegative())
+          approximation += Integer(1LL) << (Integer::limbBits * precision);
+      }
+      montgomeryFactor =
+          (Integer(1LL) << (Integer::limbBits * size)) - approximation;
+    }
+    radixSquared = reduce(Integer(1LL) << (2 * Integer::limbBits * size));
+  }
+
+  const Integer &value() const { return modulus; }
+  bool isMontgomery() const { return montgomery; }
+
+  Integer reduce(Integer number) const {
+    bool negative = number.isNegative();
+    number.negative = false;
+    barrettReduce(number);
+    if (negative && !number.isZero())
+      number = modulus - number;
+    return number;
+  }
+
+  Integer multiply(const Integer &first, const Integer &second) const {
+    return reduce(first * second);
+  }
+
+  Integer power(const Integer &base, const Integer &exponent) const {
+    PROFILE_KERNEL("powMod",
+                   (modulus.limbs.size() + exponent.limbs.size()) *
+                       sizeof(Integer::Limb));
+    if (exponent.isNegative())
+      return power(inverse(base), -exponent);
+    if (modulus == Integer(1LL))
+      return Integer();
+    size_t bits = exponent.bitLength();
+    size_t window = bits > 671  ? 6
+                    : bits > 239 ? 5
+                    : bits > 79  ? 4
+                    : bits > 23  ? 3
+                                 : 1;
+    std::vector<Integer> table(size_t(1) << (window - 1));
+    table[0] = reduce(base);
+    if (montgomery)
+      table[0] = product(table[0], radixSquared);
+    if (table.size() > 1) {
+      Integer squared = product(table[0], table[0]);
+      for (size_t index = 1; index < table.size(); ++index)
+        table[index] = product(table[index - 1], squared);
+    }
+
+    Integer result;
+    bool started = false;
+    for (size_t bit = bits; bit > 0;) {
+      Integer::checkCancellation();
+      if (!exponent.testBit(bit - 1)) {
+        if (started)
+          result = product(result, result);
+        --bit;
+        continue;
+      }
+      size_t low = bit > window ? bit - window : 0;
+      while (!exponent.testBit(low))
+        ++low;
+      size_t digit = 0;
+      for (size_t position = bit; position > low; --position) {
+        digit = 2 * digit + exponent.testBit(position - 1);
+        if (started)
+          result = product(result, result);
+      }
+      result = started ? product(result, table[digit / 2]) : table[digit / 2];
+      started = true;
+      bit = low;
+    }
+    if (!started)
+      return Integer(1LL);
+    if (montgomery)
+      montgomeryReduce(result);
+    return result;
+  }
+
+  Integer inverse(const Integer &number) const {
+    auto [divisor, factor, cofactor] = extendedGcd(reduce(number), modulus);
+    if (divisor != Integer(1LL))
+      throw std::domain_error("Value is not invertible");
+    return reduce(std::move(factor));
+  }
+
+private:
+  Integer product(const Integer &first, const Integer &second) const {
+    Integer result = first * second;
+    if (montgomery)
+      montgomeryReduce(result);
+    else
+      barrettReduce(result);
+    return result;
+  }
+
+  void barrettReduce(Integer &number) const {
+    if (size < 2 || number.limbs.size() > 2 * size) {
+      number %= modulus;
+      return;
+    }
+    Integer quotient =
+        (number.highLimbs(size - 1) * reciprocal).highLimbs(size + 1);
+    submul(number, quotient, modulus);
+    while (Integer::compareAbsolute(number, modulus) >= 0)
+      number -= modulus;
+  }
+
+  void montgomeryReduce(Integer &number) const {
+    if (size < montgomeryMultiplicationThreshold) {
+      number.limbs.resize(2 * size + 1);
+      Integer::Limb *data = number.limbs.data();
+      for (size_t index = 0; index < size; ++index) {
+        Integer::Limb carry =
+            Integer::addMultipleLimbs(data + index, modulus.limbs.data(), size,
+                                      data[index] * montgomeryInverse);
+        Integer::addLimbs(data + index + size, size + 1 - index, &carry, 1);
+      }
+      number.limbs.erase(data, data + size);
+      number.removeLeadingZeros();
+    } else {
+      Integer factor =
+          (number.lowLimbs(size) * montgomeryFactor).lowLimbs(size);
+      addmul(number, factor, modulus);
+      number = number.highLimbs(size);
+    }
+    if (Integer::compareAbsolute(number, modulus) >= 0)
+      number -= modulus;
+  }
+
+  Integer modulus;
+  size_t size;
+  Integer reciprocal;
+  Integer::Limb montgomeryInverse;
+  Integer montgomeryFactor;
+  Integer radixSquared;
+  bool montgomery;
+
+  friend class Factorizer;
+};
+
+inline Integer powMod(const Integer &base, const Integer &exponent,
+                      const Integer &modulus) {
+  return Modulus(modulus).power(base, exponent);
+}
+
+inline Integer modInverse(const Integer &value, const Integer &modulus) {
+  return Modulus(modulus).inverse(value);
+}
+
+inline int jacobi(const Integer &value, const Integer &modulus) {
+  if (modulus.isNegative() || !modulus.testBit(0))
+    throw std::domain_error("Jacobi symbol needs a positive odd modulus");
+  Integer top = value % modulus, bottom = modulus;
+  if (top.isNegative())
+    top += modulus;
+  int result = 1;
+  while (!top.isZero()) {
+    size_t twos = 0;
+    while (!top.testBit(twos))
+      ++twos;
+    top >>= twos;
+    bool bottomThree = bottom.testBit(1), bottomFive = bottom.testBit(2);
+    if (twos % 2 && bottomThree != bottomFive)
+      result = -result;
+    if (top.testBit(1) && bottomThree)
+      result = -result;
+    std::swap(top, bottom);
+    top %= bottom;
+  }
+  return bottom == Integer(1LL) ? result : 0;
+}
+
+inline bool isPrime64(std::uint64_t value) {
+  using Wide = unsigned __int128;
+  static constexpr std::uint64_t bases[] = {2,  3,  5,  7,  11, 13,
+                                            17, 19, 23, 29, 31, 37};
+  if (value < 2)
     return false;
-  if (number == Integer(2LL) || number == Integer(3LL))
+  for (std::uint64_t prime : bases)
+    if (value % prime == 0)
+      return value == prime;
+  if (value < 41 * 41)
     return true;
-  if ((number % Integer(2LL)).isZero())
-    return false;
-  std::string numberString = number.toString();
-  if (numberString.size() > 12)
-    throw std::domain_error("Number too large for primality check");
-  long long value = std::stoll(numberString);
-  for (long long i = 3; i * i <= value; i += 2)
-    if (value % i == 0)
+  std::uint64_t odd = value - 1;
+  int twos = __builtin_ctzll(odd);
+  odd >>= twos;
+  for (std::uint64_t base : bases) {
+    std::uint64_t current = 1, factor = base;
+    for (std::uint64_t exponent = odd; exponent; exponent >>= 1) {
+      if (exponent & 1)
+        current = static_cast<std::uint64_t>(Wide(current) * factor % value);
+      factor = static_cast<std::uint64_t>(Wide(factor) * factor % value);
+    }
+    if (current == 1 || current == value - 1)
+      continue;
+    bool witness = true;
+    for (int round = 1; round < twos && witness; ++round) {
+      current = static_cast<std::uint64_t>(Wide(current) * current % value);
+      witness = current != value - 1;
+    }
+    if (witness)
       return false;
+  }
   return true;
 }
+
+inline bool isStrongProbablePrime(const Integer &number, const Integer &base) {
+  Integer predecessor = number - Integer(1LL);
+  size_t twos = 0;
+  while (!predecessor.testBit(twos))
+    ++twos;
+  Modulus context(number);
+  Integer current = context.power(base, predecessor >> twos);
+  if (current == Integer(1LL) || current == predecessor)
+    return true;
+  for (size_t round = 1; round < twos; ++round) {
+    Integer::checkCancellation();
+    current = context.multiply(current, current);
+    if (current == predecessor)
+      return true;
+  }
+  return false;
+}
+
+inline bool isStrongLucasProbablePrime(const Integer &number) {
+  long long discriminant = 5;
+  for (int attempt = 0;; ++attempt) {
+    int symbol = jacobi(Integer(discriminant), number);
+    if (symbol == -1)
+      break;
+    if (symbol == 0 && Integer(discriminant).magnitude() != number.magnitude())
+      return false;
+    if (attempt == 16 && square(isqrt(number)) == number)
+      return false;
+    discriminant = discriminant > 0 ? -(discriminant + 2) : -discriminant + 2;
+  }
+
+  Modulus context(number);
+  auto halve = [&number](const Integer &value) {
+    return (value.testBit(0) ? value + number : value) >> 1;
+  };
+  Integer q = context.reduce(Integer((1 - discriminant) / 4));
+  Integer d = context.reduce(Integer(discriminant));
+  Integer successor = number + Integer(1LL);
+  size_t twos = 0;
+  while (!successor.testBit(twos))
+    ++twos;
+  Integer odd = successor >> twos;
+
+  Integer u(1LL), v(1LL), qPower = q;
+  for (size_t bit = odd.bitLength() - 1; bit > 0; --bit) {
+    Integer::checkCancellation();
+    u = context.multiply(u, v);
+    v = context.reduce(square(v) - qPower - qPower);
+    qPower = context.multiply(qPower, qPower);
+    if (odd.testBit(bit - 1)) {
+      Integer nextU = halve(u + v);
+      v = halve(context.reduce(d * u + v));
+      u = context.reduce(std::move(nextU));
+      qPower = context.multiply(qPower, q);
+    }
+  }
+  if (u.isZero() || v.isZero())
+    return true;
+  for (size_t round = 1; round < twos; ++round) {
+    Integer::checkCancellation();
+    v = context.reduce(square(v) - qPower - qPower);
+    if (v.isZero())
+      return true;
+    qPower = context.multiply(qPower, qPower);
+  }
+  return false;
+}
+
+inline bool isPrime(const Integer &number) {
+  if (number.isNegative() || number.isZero())
+    return false;
+  PROFILE_KERNEL("isPrime", number.limbs.size() * sizeof(Integer::Limb));
+  if (number.limbs.size() == 1)
+    return isPrime64(number.limbs[0]);
+
+  for (const SmallPrimeGroup &group : smallPrimeGroups) {
+    Integer::Limb residue = number.moduloLimb(group.product);
+    for (unsigned index = group.begin; index < group.end; ++index)
+      if (residue % smallPrimes[index] == 0)
+        return false;
+  }
+  return isStrongProbablePrime(number, Integer(2LL)) &&
+         isStrongLucasProbablePrime(number);
+}
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+class LimbKernels {
+public:
+  using Limb = std::uint64_t;
+
+  static Limb add(Limb *result, const Limb *first, const Limb *second,
+                  size_t size) {
+    if (size < vectorThreshold)
+      return addScalar(result, first, second, size, 0);
+    return kernels().add(result, first, second, size);
+  }
+
+  static Limb subtract(Limb *result, const Limb *first, const Limb *second,
+                       size_t size) {
+    if (size < vectorThreshold)
+      return subtractScalar(result, first, second, size, 0);
+    return kernels().subtract(result, first, second, size);
+  }
+
+  static int compare(const Limb *first, const Limb *second, size_t size) {
+    if (size < vectorThreshold)
+      return compareScalar(first, second, size);
+    return kernels().compare(first, second, size);
+  }
+
+  static const char *implementation() { return kernels().name; }
+
+  struct Table {
+    Limb (*add)(Limb *, const Limb *, const Limb *, size_t);
+    Limb (*subtract)(Limb *, const Limb *, const Limb *, size_t);
+    int (*compare)(const Limb *, const Limb *, size_t);
+    const char *name;
+  };
+
+  static std::vector<Table> available() {
+    std::vector<Table> tables{
+        {addPortable, subtractPortable, compareScalar, "scalar"}};
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+      tables.push_back({addAvx2, subtractAvx2, compareAvx2, "avx2"});
+    if (__builtin_cpu_supports("avx512f"))
+      tables.push_back({addAvx512, subtractAvx512, compareAvx512, "avx512"});
+#endif
+    return tables;
+  }
+
+private:
+  static constexpr size_t vectorThreshold = 16;
+
+  static Limb addScalar(Limb *result, const Limb *first, const Limb *second,
+                        size_t size, Limb carry) {
+#if defined(__x86_64__)
+    unsigned char flag = static_cast<unsigned char>(carry);
+    for (size_t index = 0; index < size; ++index) {
+      unsigned long long sum;
+      flag = _addcarry_u64(flag, first[index], second[index], &sum);
+      result[index] = sum;
+    }
+    return flag;
+#else
+    for (size_t index = 0; index < size; ++index) {
+      unsigned __int128 sum =
+          static_cast<unsigned __int128>(first[index]) + second[index] + carry;
+      result[index] = static_cast<Limb>(sum);
+      carry = static_cast<Limb>(sum >> 64);
+    }
+    return carry;
+#endif
+  }
+
+  static Limb subtractScalar(Limb *result, const Limb *first,
+                             const Limb *second, size_t size, Limb borrow) {
+#if defined(__x86_64__)
+    unsigned char flag = static_cast<unsigned char>(borrow);
+    for (size_t index = 0; index < size; ++index) {
+      unsigned long long difference;
+      flag = _subborrow_u64(flag, first[index], second[index], &difference);
+      result[index] = difference;
+    }
+    return flag;
+#else
+    for (size_t index = 0; index < size; ++index) {
+      unsigned __int128 difference =
+          static_cast<unsigned __int128>(first[index]) - second[index] - borrow;
+      result[index] = static_cast<Limb>(difference);
+      borrow = static_cast<Limb>(difference >> 64) & 1;
+    }
+    return borrow;
+#endif
+  }
+
+  static int compareScalar(const Limb *first, const Limb *second,
+                           size_t size) {
+    for (size_t index = size; index > 0; --index)
+      if (first[index - 1] != second[index - 1])
+        return first[index - 1] < second[index - 1] ? -1 : 1;
+    return 0;
+  }
+
+  static Limb addPortable(Limb *result, const Limb *first, const Limb *second,
+                          size_t size) {
+    return addScalar(result, first, second, size, 0);
+  }
+
+  static Limb subtractPortable(Limb *result, const Limb *first,
+                               const Limb *second, size_t size) {
+    return subtractScalar(result, first, second, size, 0);
+  }
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+  __attribute__((target("avx2"))) static Limb
+  addAvx2(Limb *result, const Limb *first, const Limb *second, size_t size) {
+    const __m256i signBit = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i allOnes = _mm256_set1_epi64x(-1);
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i lanes = _mm256_setr_epi64x(0, 1, 2, 3);
+    unsigned carry = 0;
+    size_t index = 0;
+    for (; index + 4 <= size; index += 4) {
+      __m256i left = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(first + index));
+      __m256i right = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(second + index));
+      __m256i sum = _mm256_add_epi64(left, right);
+      unsigned generate = static_cast<unsigned>(_mm256_movemask_pd(
+          _mm256_castsi256_pd(_mm256_cmpgt_epi64(
+              _mm256_xor_si256(left, signBit),
+              _mm256_xor_si256(sum, signBit)))));
+      unsigned propagate = static_cast<unsigned>(_mm256_movemask_pd(
+          _mm256_castsi256_pd(_mm256_cmpeq_epi64(sum, allOnes))));
+      unsigned carries = (generate << 1) + carry + propagate;
+      carry = carries >> 4;
+      __m256i incoming = _mm256_and_si256(
+          _mm256_srlv_epi64(
+              _mm256_set1_epi64x((carries ^ propagate) & 0xf), lanes),
+          one);
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(result + index),
+                          _mm256_add_epi64(sum, incoming));
+    }
+    return addScalar(result + index, first + index, second + index,
+                     size - index, carry);
+  }
+
+  __attribute__((target("avx2"))) static Limb
+  subtractAvx2(Limb *result, const Limb *first, const Limb *second,
+               size_t size) {
+    const __m256i signBit = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i lanes = _mm256_setr_epi64x(0, 1, 2, 3);
+    unsigned borrow = 0;
+    size_t index = 0;
+    for (; index + 4 <= size; index += 4) {
+      __m256i left = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(first + index));
+      __m256i right = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i *>(second + index));
+      __m256i difference = _mm256_sub_epi64(left, right);
+      unsigned generate = static_cast<unsigned>(_mm256_movemask_pd(
+          _mm256_castsi256_pd(_mm256_cmpgt_epi64(
+              _mm256_xor_si256(right, signBit),
+              _mm256_xor_si256(left, signBit)))));
+      unsigned propagate = static_cast<unsigned>(_mm256_movemask_pd(
+          _mm256_castsi256_pd(_mm256_cmpeq_epi64(difference, zero))));
+      unsigned borrows = (generate << 1) + borrow + propagate;
+      borrow = borrows >> 4;
+      __m256i incoming = _mm256_and_si256(
+          _mm256_srlv_epi64(
+              _mm256_set1_epi64x((borrows ^ propagate) & 0xf), lanes),
+          one);
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(result + index),
+                          _mm256_sub_epi64(difference, incoming));
+    }
+    return subtractScalar(result + index, first + index, second + index,
+                          size - index, borrow);
+  }
+
+  __attribute__((target("avx2"))) static int
+  compareAvx2(const Limb *first, const Limb *second, size_t size) {
+    size_t index = size;
+    for (; index >= 4; index -= 4) {
+      __m256i equal = _mm256_cmpeq_epi64(
+          _mm256_loadu_si256(
+              reinterpret_cast<const __m256i *>(first + index - 4)),
+          _mm256_loadu_si256(
+              reinterpret_cast<const __m256i *>(second + index - 4)));
+      unsigned different =
+          ~static_cast<unsigned>(
+              _mm256_movemask_pd(_mm256_castsi256_pd(equal))) &
+          0xf;
+      if (different) {
+        size_t lane = index - 4 + 31 - __builtin_clz(different);
+        return first[lane] < second[lane] ? -1 : 1;
+      }
+    }
+    return compareScalar(first, second, index);
+  }
+
+  __attribute__((target("avx512f"))) static Limb
+  addAvx512(Limb *result, const Limb *first, const Limb *second,
+            size_t size) {
+    const __m512i allOnes = _mm512_set1_epi64(-1);
+    const __m512i one = _mm512_set1_epi64(1);
+    unsigned carry = 0;
+    size_t index = 0;
+    for (; index + 8 <= size; index += 8) {
+      __m512i left = _mm512_loadu_si512(first + index);
+      __m512i sum = _mm512_add_epi64(left, _mm512_loadu_si512(second + index));
+      unsigned generate = _mm512_cmplt_epu64_mask(sum, left);
+      unsigned propagate = _mm512_cmpeq_epu64_mask(sum, allOnes);
+      unsigned carries = (generate << 1) + carry + propagate;
+      carry = carries >> 8;
+      _mm512_storeu_si512(
+          result + index,
+          _mm512_mask_add_epi64(
+              sum, static_cast<__mmask8>(carries ^ propagate), sum, one));
+    }
+    return addScalar(result + index, first + index, second + index,
+                     size - index, carry);
+  }
+
+  __attribute__((target("avx512f"))) static Limb
+  subtractAvx512(Limb *result, const Limb *first, const Limb *second,
+                 size_t size) {
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i one = _mm512_set1_epi64(1);
+    unsigned borrow = 0;
+    size_t index = 0;
+    for (; index + 8 <= size; index += 8) {
+      __m512i left = _mm512_loadu_si512(first + index);
+      __m512i right = _mm512_loadu_si512(second + index);
+      __m512i difference = _mm512_sub_epi64(left, right);
+      unsigned generate = _mm512_cmplt_epu64_mask(left, right);
+      unsigned propagate = _mm512_cmpeq_epu64_mask(difference, zero);
+      unsigned borrows = (generate << 1) + borrow + propagate;
+      borrow = borrows >> 8;
+      _mm512_storeu_si512(
+          result + index,
+          _mm512_mask_sub_epi64(difference,
+                                static_cast<__mmask8>(borrows ^ propagate),
+                                difference, one));
+    }
+    return subtractScalar(result + index, first + index, second + index,
+                          size - index, borrow);
+  }
+
+  __attribute__((target("avx512f"))) static int
+  compareAvx512(const Limb *first, const Limb *second, size_t size) {
+    size_t index = size;
+    for (; index >= 8; index -= 8) {
+      unsigned different = _mm512_cmpneq_epu64_mask(
+          _mm512_loadu_si512(first + index - 8),
+          _mm512_loadu_si512(second + index - 8));
+      if (different) {
+        size_t lane = index - 8 + 31 - __builtin_clz(different);
+        return first[lane] < second[lane] ? -1 : 1;
+      }
+    }
+    return compareScalar(first, second, index);
+  }
+#endif
+
+  static Table select() { return available().back(); }
+
+  static const Table &kernels() {
+    static const Table table = select();
+    return table;
+  }
+};
@@ -1,30 +1,104 @@
 #include "MainWindow.hh"
 
+#include <QAction>
 #include <QApplication>
+#include <QCheckBox>
 #include <QClipboard>
+#include <QDir>
+#include <QFileDialog>
 #include <QGridLayout>
 #include <QGroupBox>
 #include <QHBoxLayout>
 #include <QLabel>
-#include <QListWidget>
+#include <QLineEdit>
+#include <QListView>
+#include <QMenuBar>
 #include <QMessageBox>
+#include <QProgressBar>
 #include <QPushButton>
+#include <QSpinBox>
+#include <QStandardPaths>
 #include <QTextEdit>
+#include <QTimer>
 #include <QVBoxLayout>
+#include <QtConcurrent/QtConcurrent>
 
+#include "Expression.hh"
+#include "Factorization.hh"
+#include "HistoryModel.hh"
 #include "Integer.hh"
+#include "Profiler.hh"
+#include "ResultCache.hh"
+
+#ifdef CALCULATOR_PROFILE
+#include "ProfilerPanel.hh"
+#endif
+
+namespace {
+
+Integer parseOperand(const QString &text) {
+  if (text.startsWith('@'))
+    return Integer::load(text.mid(1).toStdString());
+  return Integer(text.toStdString());
+}
+
+const Integer &parseOperand(OperationResult &result, const QString &text) {
+  result.operands.push_back(
+      std::make_shared<const Integer>(parseOperand(text)));
+  result.previews.append(text.startsWith('@') ? text
+                                              : HistoryModel::preview(text));
+  return *result.operands.back();
+}
+
+QStringList splitList(const QString &text) {
+  QStringList items;
+  QString item;
+  for (const QChar &character : text) {
+    if (!character.isSpace() && character != ',' && character != ';') {
+      item += character;
+      continue;
+    }
+    if (!item.isEmpty())
+      items.append(item);
+    item.clear();
+  }
+  if (!item.isEmpty())
+    items.append(item);
+  return items;
+}
+
+} // namespace
 
 MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
   setWindowTitle("Калькулятор больших чисел");
   resize(900, 600);
 
+  QMenu *fileMenu = menuBar()->addMenu("Файл");
+  QAction *saveResult = fileMenu->addAction("Сохранить результат…");
+  saveResult->setShortcut(QKeySequence::Save);
+  fileMenu->addSeparator();
+  QAction *loadFirst = fileMenu->addAction("Загрузить число 1…");
+  QAction *loadSecond = fileMenu->addAction("Загрузить число 2…");
+  QAction *loadModulus = fileMenu->addAction("Загрузить модуль…");
+
+#ifdef CALCULATOR_PROFILE
+  auto *profilerPanel = new ProfilerPanel(this);
+  addDockWidget(Qt::BottomDockWidgetArea, profilerPanel);
+  profilerPanel->hide();
+  menuBar()->addMenu("Вид")->addAction(profilerPanel->toggleViewAction());
+#endif
+
   auto *central = new QWidget(this);
   setCentralWidget(central);
   auto *mainLayout = new QHBoxLayout(central);
 
   auto *leftLayout = new QVBoxLayout;
 
-  leftLayout->addWidget(new QLabel("Число 1:"));
+  auto *firstNumberLayout = new QHBoxLayout;
+  m_listMode = new QCheckBox("Список: +, ×, НОД и НОК по всем числам");
+  firstNumberLayout->addWidget(new QLabel("Число 1:"), 1);
+  firstNumberLayout->addWidget(m_listMode);
+  leftLayout->addLayout(firstNumberLayout);
   m_firstNumberInput = new QTextEdit;
   m_firstNumberInput->setMaximumHeight(70);
   leftLayout->addWidget(m_firstNumberInput);
@@ -34,6 +108,21 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
   m_secondNumberInput->setMaximumHeight(70);
   leftLayout->addWidget(m_secondNumberInput);
 
+  leftLayout->addWidget(new QLabel("Модуль:"));
+  m_modulusInput = new QTextEdit;
+  m_modulusInput->setMaximumHeight(70);
+  leftLayout->addWidget(m_modulusInput);
+
+  leftLayout->addWidget(
+      new QLabel("Выражение (a, b, m — числа 1, 2 и модуль):"));
+  auto *expressionLayout = new QHBoxLayout;
+  m_expressionInput = new QLineEdit;
+  m_expressionInput->setPlaceholderText("k = 64; gcd(a^k - 1, b^k - 1)");
+  auto *buttonEvaluate = new QPushButton("Вычислить");
+  expressionLayout->addWidget(m_expressionInput, 1);
+  expressionLayout->addWidget(buttonEvaluate);
+  leftLayout->addLayout(expressionLayout);
+
   m_operationLabel = new QLabel("Операция: -");
   leftLayout->addWidget(m_operationLabel);
 
@@ -46,10 +135,16 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
   auto *buttonDivide = new QPushButton("/");
   auto *buttonModulo = new QPushButton("%");
   auto *buttonPower = new QPushButton("^");
+  auto *buttonPowerModulo = new QPushButton("^ mod");
+  auto *buttonModularInverse = new QPushButton("1/a mod");
   auto *buttonFactorial = new QPushButton("N!");
   auto *buttonGcd = new QPushButton("НОД");
   auto *buttonLcm = new QPushButton("НОК");
   auto *buttonPrime = new QPushButton("Простое?");
+  auto *buttonSquareRoot = new QPushButton("√");
+  auto *buttonRoot = new QPushButton("ⁿ√");
+  auto *buttonPerfectPower = new QPushButton("Точная степень?");
+  auto *buttonFactorize = new QPushButton("Разложить");
   auto *buttonClear = new QPushButton("Очистить");
   auto *buttonCopy = new QPushButton("Копировать");
 
@@ -59,15 +154,40 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
   grid->addWidget(buttonDivide, 1, 0);
   grid->addWidget(buttonModulo, 1, 1);
   grid->addWidget(buttonPower, 1, 2);
+  grid->addWidget(buttonPowerModulo, 1, 3);
+  grid->addWidget(buttonModularInverse, 2, 3);
   grid->addWidget(buttonFactorial, 2, 0);
   grid->addWidget(buttonGcd, 2, 1);
   grid->addWidget(buttonLcm, 2, 2);
   grid->addWidget(buttonPrime, 3, 0);
   grid->addWidget(buttonClear, 3, 1);
   grid->addWidget(buttonCopy, 3, 2);
+  grid->addWidget(buttonSquareRoot, 0, 3);
+  grid->addWidget(buttonRoot, 3, 3);
+  grid->addWidget(buttonPerfectPower, 4, 0, 1, 4);
+  grid->addWidget(buttonFactorize, 5, 0, 1, 2);
+
+  m_factorTimeLimit = new QSpinBox;
+  m_factorTimeLimit->setRange(0, 86400);
+  m_factorTimeLimit->setSuffix(" с");
+  m_factorTimeLimit->setSpecialValueText("Без лимита");
+  m_factorTimeLimit->setValue(60);
+  grid->addWidget(m_factorTimeLimit, 5, 2, 1, 2);
 
   leftLayout->addWidget(group);
 
+  auto *statusLayout = new QHBoxLayout;
+  m_progressBar = new QProgressBar;
+  m_progressBar->setRange(0, 0);
+  m_progressBar->setVisible(false);
+  m_statusLabel = new QLabel;
+  m_cancelButton = new QPushButton("Отмена");
+  m_cancelButton->setEnabled(false);
+  statusLayout->addWidget(m_progressBar);
+  statusLayout->addWidget(m_statusLabel, 1);
+  statusLayout->addWidget(m_cancelButton);
+  leftLayout->addLayout(statusLayout);
+
   leftLayout->addWidget(new QLabel("Результат:"));
   m_resultOutput = new QTextEdit;
   m_resultOutput->setMaximumHeight(80);
@@ -77,10 +197,33 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
 
   auto *rightLayout = new QVBoxLayout;
   rightLayout->addWidget(new QLabel("История:"));
-  m_historyList = new QListWidget;
-  rightLayout->addWidget(m_historyList);
+  m_historyModel = new HistoryModel(this);
+  m_historyView = new QListView;
+  m_historyView->setModel(m_historyModel);
+  m_historyView->setUniformItemSizes(true);
+  rightLayout->addWidget(m_historyView);
+  auto *copyHistoryEntry = new QAction("Копировать запись", m_historyView);
+  copyHistoryEntry->setShortcut(QKeySequence::Copy);
+  copyHistoryEntry->setShortcutContext(Qt::WidgetShortcut);
+  m_historyView->addAction(copyHistoryEntry);
+  m_historyView->setContextMenuPolicy(Qt::ActionsContextMenu);
+  auto *historyLayout = new QHBoxLayout;
   auto *buttonClearHistory = new QPushButton("Очистить историю");
-  rightLayout->addWidget(buttonClearHistory);
+  m_historyLimit = new QSpinBox;
+  m_historyLimit->setRange(1, 4096);
+  m_historyLimit->setPrefix("Лимит: ");
+  m_historyLimit->setSuffix(" МБ");
+  m_historyLimit->setValue(
+      static_cast<int>(m_historyModel->memoryLimit() >> 20));
+  historyLayout->addWidget(buttonClearHistory, 1);
+  historyLayout->addWidget(m_historyLimit);
+  rightLayout->addLayout(historyLayout);
+  auto *cacheLayout = new QHBoxLayout;
+  m_cacheLabel = new QLabel;
+  auto *buttonClearCache = new QPushButton("Очистить кэш");
+  cacheLayout->addWidget(m_cacheLabel, 1);
+  cacheLayout->addWidget(buttonClearCache);
+  rightLayout->addLayout(cacheLayout);
 
   mainLayout->addLayout(leftLayout, 3);
   mainLayout->addLayout(rightLayout, 2);
@@ -91,18 +234,89 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent) {
   connect(buttonDivide, &QPushButton::clicked, this, &MainWindow::onDivide);
   connect(buttonModulo, &QPushButton::clicked, this, &MainWindow::onModulo);
   connect(buttonPower, &QPushButton::clicked, this, &MainWindow::onPower);
+  connect(buttonPowerModulo, &QPushButton::clicked, this,
+          &MainWindow::onPowerModulo);
+  connect(buttonModularInverse, &QPushButton::clicked, this,
+          &MainWindow::onModularInverse);
   connect(buttonFactorial, &QPushButton::clicked, this,
           &MainWindow::onFactorial);
   connect(buttonGcd, &QPushButton::clicked, this, &MainWindow::onGcd);
   connect(buttonLcm, &QPushButton::clicked, this, &MainWindow::onLcm);
   connect(buttonPrime, &QPushButton::clicked, this, &MainWindow::onCheckPrime);
+  connect(buttonSquareRoot, &QPushButton::clicked, this,
+          &MainWindow::onSquareRoot);
+  connect(buttonRoot, &QPushButton::clicked, this, &MainWindow::onRoot);
+  connect(buttonPerfectPower, &QPushButton::clicked, this,
+          &MainWindow::onCheckPerfectPower);
+  connect(buttonFactorize, &QPushButton::clicked, this,
+          &MainWindow::onFactorize);
+  connect(buttonEvaluate, &QPushButton::clicked, this,
+          &MainWindow::onEvaluate);
   connect(buttonClear, &QPushButton::clicked, this, &MainWindow::onClear);
   connect(buttonCopy, &QPushButton::clicked, this, &MainWindow::onCopyResult);
   connect(buttonClearHistory, &QPushButton::clicked, this,
           &MainWindow::onClearHistory);
+  connect(buttonClearCache, &QPushButton::clicked, this,
+          &MainWindow::onClearCache);
+  connect(m_historyView->selectionModel(),
+          &QItemSelectionModel::currentChanged, this,
+          &MainWindow::onHistorySelected);
+  connect(copyHistoryEntry, &QAction::triggered, this,
+          &MainWindow::onCopyHistoryEntry);
+  connect(m_historyLimit, qOverload<int>(&QSpinBox::valueChanged), this,
+          [this](int megabytes) {
+            m_historyModel->setMemoryLimit(size_t(megabytes) << 20);
+          });
+  connect(m_cancelButton, &QPushButton::clicked, this, &MainWindow::onCancel);
+  connect(m_listMode, &QCheckBox::toggled, this,
+          &MainWindow::onListModeToggled);
+  connect(saveResult, &QAction::triggered, this, &MainWindow::onSaveResult);
+  connect(loadFirst, &QAction::triggered, this,
+          [this] { loadOperand(m_firstNumberInput); });
+  connect(loadSecond, &QAction::triggered, this,
+          [this] { loadOperand(m_secondNumberInput); });
+  connect(loadModulus, &QAction::triggered, this,
+          [this] { loadOperand(m_modulusInput); });
+
+  m_operationButtons = {buttonAdd,          buttonSubtract,
+                        buttonMultiply,     buttonDivide,
+                        buttonModulo,       buttonPower,
+                        buttonPowerModulo,  buttonModularInverse,
+                        buttonFactorial,    buttonGcd,
+                        buttonLcm,          buttonPrime,
+                        buttonSquareRoot,   buttonRoot,
+                        buttonPerfectPower, buttonFactorize,
+                        buttonEvaluate};
+  m_listButtons = {buttonAdd, buttonMultiply, buttonGcd, buttonLcm};
+
+  m_elapsedTimer = new QTimer(this);
+  m_elapsedTimer->setInterval(100);
+  connect(m_elapsedTimer, &QTimer::timeout, this, &MainWindow::onElapsedTick);
+  connect(&m_watcher, &QFutureWatcher<OperationResult>::finished, this,
+          &MainWindow::onOperationFinished);
+
+  QString dataPath =
+      QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+  if (QDir().mkpath(dataPath)) {
+    m_cachePath = QDir(dataPath).filePath("results.cache");
+    try {
+      ResultCache::instance().load(m_cachePath.toStdString());
+    } catch (const std::exception &) {
+    }
+  }
+  updateCacheStatus();
+}
+
+MainWindow::~MainWindow() {
+  m_cancelRequested = true;
+  m_watcher.waitForFinished();
+  if (!m_cachePath.isEmpty())
+    ResultCache::instance().save(m_cachePath.toStdString());
 }
 
 QString MainWindow::cleanInput(const QString &raw) {
+  if (raw.trimmed().startsWith('@'))
+    return raw.trimmed();
   QString cleaned;
   for (const QChar &character : raw)
     if (!character.isSpace())
@@ -115,6 +329,8 @@ bool MainWindow::validateInput(const QString &text, const QString &fieldName) {
     QMessageBox::warning(this, "Ошибка", fieldName + " не заполнено.");
     return false;
   }
+  if (text[0] == '@')
+    return true;
   int start = 0;
   if (text[0] == '-' || text[0] == '+')
     start = 1;
@@ -132,8 +348,153 @@ bool MainWindow::validateInput(const QString &text, const QString &fieldName) {
   return true;
 }
 
-void MainWindow::appendHistory(const QString &entry) {
-  m_historyList->insertItem(0, entry);
+void MainWindow::appendHistory(const QString &pattern,
+                               const OperationResult &result,
+                               const QStringList &texts) {
+  PROFILE_SCOPE("ui.history", 0);
+  m_historyModel->prepend(pattern, result.operands, result.previews,
+                          result.number, texts);
+}
+
+void MainWindow::startOperation(
+    const QString &name, std::function<QString(OperationResult &)> task,
+    std::function<void(const OperationResult &)> onSuccess) {
+  runOperation(
+      name,
+      [task = std::move(task)](OperationResult &result) {
+        result.value = task(result);
+      },
+      std::move(onSuccess));
+}
+
+void MainWindow::startOperation(
+    const QString &name, std::function<Integer(OperationResult &)> task,
+    std::function<void(const OperationResult &)> onSuccess) {
+  runOperation(
+      name,
+      [task = std::move(task)](OperationResult &result) {
+        auto number = std::make_shared<const Integer>(task(result));
+        result.value = QString::fromStdString(number->toString());
+        result.previews.append(HistoryModel::preview(result.value));
+        result.number = std::move(number);
+      },
+      std::move(onSuccess));
+}
+
+void MainWindow::runOperation(
+    const QString &name, std::function<void(OperationResult &)> task,
+    std::function<void(const OperationResult &)> onSuccess) {
+  m_operationLabel->setText("Операция: " + name);
+  m_cancelRequested = false;
+  m_onSuccess = std::move(onSuccess);
+  setBusy(true);
+  m_elapsed.start();
+  onElapsedTick();
+  m_elapsedTimer->start();
+
+  m_watcher.setFuture(QtConcurrent::run([this, task = std::move(task)] {
+    OperationResult result;
+    Integer::CancellationScope scope(m_cancelRequested);
+    PROFILE_SCOPE("ui.task", 0);
+    try {
+      task(result);
+    } catch (const Integer::Cancelled &) {
+      result.cancelled = true;
+    } catch (const std::exception &exception) {
+      result.error = QString::fromUtf8(exception.what());
+    }
+    return result;
+  }));
+}
+
+void MainWindow::setBusy(bool busy) {
+  for (QPushButton *button : m_operationButtons)
+    button->setEnabled(!busy && (!m_listMode->isChecked() ||
+                                 m_listButtons.contains(button)));
+  m_cancelButton->setEnabled(busy);
+  m_progressBar->setVisible(busy);
+}
+
+void MainWindow::onListModeToggled(bool checked) {
+  m_firstNumberInput->setMaximumHeight(checked ? 240 : 70);
+  setBusy(m_watcher.isRunning());
+}
+
+void MainWindow::onElapsedTick() {
+  m_statusLabel->setText(
+      QString("Вычисление: %1 с").arg(m_elapsed.elapsed() / 1000.0, 0, 'f', 1));
+}
+
+void MainWindow::onCancel() {
+  m_cancelRequested = true;
+  m_cancelButton->setEnabled(false);
+  m_statusLabel->setText("Отмена...");
+}
+
+void MainWindow::updateCacheStatus() {
+  ResultCache::Statistics statistics = ResultCache::instance().statistics();
+  m_cacheLabel->setText(
+      QString("Кэш: попаданий %1, промахов %2, %3 зап., %4 МБ")
+          .arg(statistics.hits)
+          .arg(statistics.misses)
+          .arg(statistics.entries)
+          .arg(statistics.bytes / 1048576.0, 0, 'f', 1));
+}
+
+void MainWindow::onOperationFinished() {
+  PROFILE_SCOPE("ui.finished", 0);
+  m_elapsedTimer->stop();
+  setBusy(false);
+  updateCacheStatus();
+  OperationResult result = m_watcher.result();
+  QString seconds = QString::number(m_elapsed.elapsed() / 1000.0, 'f', 2);
+  if (result.cancelled) {
+    m_statusLabel->setText("Отменено через " + seconds + " с");
+    return;
+  }
+  if (!result.error.isEmpty()) {
+    m_statusLabel->setText("Ошибка");
+    QMessageBox::critical(this, "Ошибка", result.error);
+    return;
+  }
+  m_statusLabel->setText("Готово за " + seconds + " с");
+  {
+    PROFILE_SCOPE("ui.setText", static_cast<size_t>(result.value.size()));
+    m_resultOutput->setText(result.value);
+  }
+  m_lastResult = result.number;
+  if (m_onSuccess)
+    m_onSuccess(result);
+}
+
+void MainWindow::performListOperation(const QString &name,
+                                      const QString &symbol) {
+  QStringList items = splitList(m_firstNumberInput->toPlainText());
+  if (items.isEmpty() && !validateInput(QString(), "Список"))
+    return;
+  for (const QString &item : items)
+    if (!validateInput(item, "Список"))
+      return;
+
+  startOperation(
+      name,
+      [items, symbol](OperationResult &) {
+        std::vector<Integer> values;
+        values.reserve(items.size());
+        for (const QString &item : items)
+          values.push_back(parseOperand(item));
+        if (symbol == "+")
+          return sum(values);
+        if (symbol == "*")
+          return product(values);
+        if (symbol == "gcd")
+          return gcd(values);
+        return lcm(values);
+      },
+      [this, name, count = items.size()](const OperationResult &result) {
+        appendHistory(name + " %2 чисел = %1", result,
+                      {QString::number(count)});
+      });
 }
 
 void MainWindow::performBinaryOperation(const QString &name,
@@ -143,113 +504,307 @@ void MainWindow::performBinaryOperation(const QString &name,
   if (!validateInput(first, "Число 1") || !validateInput(second, "Число 2"))
     return;
 
-  m_operationLabel->setText("Операция: " + name);
+  startOperation(
+      name,
+      [first, second, symbol](OperationResult &operands) {
+        const Integer &numberFirst = parseOperand(operands, first);
+        const Integer &numberSecond = parseOperand(operands, second);
+        Integer result(0LL);
+        auto cached = [&](Operation operation, const auto &compute) {
+          return ResultCache::instance().get(operation, compute, numberFirst,
+                                             numberSecond);
+        };
+
+        if (symbol == "+")
+          result = numberFirst + numberSecond;
+        else if (symbol == "-")
+          result = numberFirst - numberSecond;
+        else if (symbol == "*")
+          result = cached(Operation::Multiply,
+                          [&] { return numberFirst * numberSecond; });
+        else if (symbol == "/")
+          result = cached(Operation::Divide,
+                          [&] { return numberFirst / numberSecond; });
+        else if (symbol == "%")
+          result = cached(Operation::Modulo,
+                          [&] { return numberFirst % numberSecond; });
+        else if (symbol == "^")
+          result = cached(Operation::Power,
+                          [&] { return power(numberFirst, numberSecond); });
+
+        return result;
+      },
+      [this, symbol](const OperationResult &result) {
+        appendHistory("%1 " + symbol + " %2 = %3", result);
+      });
+}
 
-  try {
-    Integer numberFirst(first.toStdString());
-    Integer numberSecond(second.toStdString());
-    Integer result(0LL);
-
-    if (symbol == "+")
-      result = numberFirst + numberSecond;
-    else if (symbol == "-")
-      result = numberFirst - numberSecond;
-    else if (symbol == "*")
-      result = numberFirst * numberSecond;
-    else if (symbol == "/")
-      result = numberFirst / numberSecond;
-    else if (symbol == "%")
-      result = numberFirst % numberSecond;
-    else if (symbol == "^")
-      result = power(numberFirst, numberSecond);
-
-    QString resultString = QString::fromStdString(result.toString());
-    m_resultOutput->setText(resultString);
-    appendHistory(first + " " + symbol + " " + second + " = " + resultString);
-  } catch (const std::exception &exception) {
-    QMessageBox::critical(this, "Ошибка", QString::fromUtf8(exception.what()));
-  }
+void MainWindow::onAdd() {
+  if (m_listMode->isChecked())
+    performListOperation("Сумма", "+");
+  else
+    performBinaryOperation("Сложение", "+");
 }
 
-void MainWindow::onAdd() { performBinaryOperation("Сложение", "+"); }
 void MainWindow::onSubtract() { performBinaryOperation("Вычитание", "-"); }
-void MainWindow::onMultiply() { performBinaryOperation("Умножение", "*"); }
+void MainWindow::onMultiply() {
+  if (m_listMode->isChecked())
+    performListOperation("Произведение", "*");
+  else
+    performBinaryOperation("Умножение", "*");
+}
+
 void MainWindow::onDivide() { performBinaryOperation("Деление", "/"); }
 void MainWindow::onModulo() { performBinaryOperation("Остаток", "%"); }
 void MainWindow::onPower() { performBinaryOperation("Степень", "^"); }
 
+void MainWindow::onPowerModulo() {
+  QString base = cleanInput(m_firstNumberInput->toPlainText());
+  QString exponent = cleanInput(m_secondNumberInput->toPlainText());
+  QString modulus = cleanInput(m_modulusInput->toPlainText());
+  if (!validateInput(base, "Число 1") || !validateInput(exponent, "Число 2") ||
+      !validateInput(modulus, "Поле «Модуль»"))
+    return;
+  startOperation(
+      "Степень по модулю",
+      [base, exponent, modulus](OperationResult &operands) {
+        const Integer &numberBase = parseOperand(operands, base);
+        const Integer &numberExponent = parseOperand(operands, exponent);
+        const Integer &numberModulus = parseOperand(operands, modulus);
+        return ResultCache::instance().get(
+            Operation::PowerModulo,
+            [&] { return powMod(numberBase, numberExponent, numberModulus); },
+            numberBase, numberExponent, numberModulus);
+      },
+      [this](const OperationResult &result) {
+        appendHistory("%1 ^ %2 mod %3 = %4", result);
+      });
+}
+
+void MainWindow::onModularInverse() {
+  QString text = cleanInput(m_firstNumberInput->toPlainText());
+  QString modulus = cleanInput(m_modulusInput->toPlainText());
+  if (!validateInput(text, "Число 1") ||
+      !validateInput(modulus, "Поле «Модуль»"))
+    return;
+  startOperation(
+      "Обратный по модулю",
+      [text, modulus](OperationResult &operands) {
+        const Integer &number = parseOperand(operands, text);
+        const Integer &numberModulus = parseOperand(operands, modulus);
+        return ResultCache::instance().get(
+            Operation::ModularInverse,
+            [&] { return modInverse(number, numberModulus); }, number,
+            numberModulus);
+      },
+      [this](const OperationResult &result) {
+        appendHistory("%1^-1 mod %2 = %3", result);
+      });
+}
+
 void MainWindow::onFactorial() {
   QString text = cleanInput(m_firstNumberInput->toPlainText());
   if (!validateInput(text, "Число 1"))
     return;
-  m_operationLabel->setText("Операция: Факториал");
-  try {
-    Integer number(text.toStdString());
-    Integer result = factorial(number);
-    QString resultString = QString::fromStdString(result.toString());
-    m_resultOutput->setText(resultString);
-    appendHistory(text + "! = " + resultString);
-  } catch (const std::exception &exception) {
-    QMessageBox::critical(this, "Ошибка", QString::fromUtf8(exception.what()));
+  startOperation(
+      "Факториал",
+      [text](OperationResult &operands) {
+        const Integer &number = parseOperand(operands, text);
+        return ResultCache::instance().get(
+            Operation::Factorial, [&] { return factorial(number); }, number);
+      },
+      [this](const OperationResult &result) {
+        appendHistory("%1! = %2", result);
+      });
+}
+
+void MainWindow::onSquareRoot() {
+  QString text = cleanInput(m_firstNumberInput->toPlainText());
+  if (!validateInput(text, "Число 1"))
+    return;
+  startOperation(
+      "Квадратный корень",
+      [text](OperationResult &operands) {
+        const Integer &number = parseOperand(operands, text);
+        return ResultCache::instance().get(
+            Operation::SquareRoot, [&] { return isqrt(number); }, number);
+      },
+      [this](const OperationResult &result) {
+        appendHistory("√%1 = %2", result);
+      });
+}
+
+void MainWindow::onRoot() {
+  QString text = cleanInput(m_firstNumberInput->toPlainText());
+  QString degree = cleanInput(m_secondNumberInput->toPlainText());
+  if (!validateInput(text, "Число 1") || !validateInput(degree, "Число 2"))
+    return;
+  startOperation(
+      "Корень степени n",
+      [text, degree](OperationResult &operands) {
+        const Integer &number = parseOperand(operands, text);
+        const Integer &numberDegree = parseOperand(operands, degree);
+        return ResultCache::instance().get(
+            Operation::Root, [&] { return iroot(number, numberDegree); },
+            number, numberDegree);
+      },
+      [this](const OperationResult &result) {
+        appendHistory("корень(%1, %2) = %3", result);
+      });
+}
+
+void MainWindow::onCheckPerfectPower() {
+  QString text = cleanInput(m_firstNumberInput->toPlainText());
+  if (!validateInput(text, "Число 1"))
+    return;
+  startOperation(
+      "Проверка на точную степень",
+      [text](OperationResult &operands) {
+        const Integer &number = parseOperand(operands, text);
+        Integer answer = ResultCache::instance().get(
+            Operation::PerfectPower,
+            [&] { return Integer(isPerfectPower(number) ? 1LL : 0LL); },
+            number);
+        return QString(answer.isZero() ? "Не точная степень"
+                                       : "Точная степень");
+      },
+      [this](const OperationResult &result) {
+        appendHistory("%1: " + result.value, result);
+        QMessageBox::information(this, "Результат", result.value);
+      });
+}
+
+void MainWindow::onFactorize() {
+  QString text = cleanInput(m_firstNumberInput->toPlainText());
+  if (!validateInput(text, "Число 1"))
+    return;
+  std::chrono::seconds budget(m_factorTimeLimit->value());
+  m_resultOutput->clear();
+  startOperation(
+      "Разложение на множители",
+      [this, text, budget](OperationResult &operands) {
+        const Integer &number = parseOperand(operands, text);
+        Factorization factorization = factorize(
+            number,
+            [this](const Integer &prime, size_t multiplicity) {
+              QString factor = QString::fromStdString(prime.toString());
+              if (multiplicity > 1)
+                factor += "^" + QString::number(multiplicity);
+              QMetaObject::invokeMethod(
+                  this, [this, factor] { m_resultOutput->append(factor); },
+                  Qt::QueuedConnection);
+            },
+            budget);
+        QString result = QString::fromStdString(factorization.toString());
+        if (!factorization.isComplete())
+          result += " (не завершено)";
+        return result;
+      },
+      [this](const OperationResult &result) {
+        appendHistory("%1 = %2", result, {result.value});
+      });
+}
+
+void MainWindow::onEvaluate() {
+  QString expression = m_expressionInput->text().trimmed();
+  if (expression.isEmpty()) {
+    QMessageBox::warning(this, "Ошибка", "Поле «Выражение» не заполнено.");
+    return;
   }
+  QStringList names = {"a", "b", "m"};
+  QStringList fields = {"Число 1", "Число 2", "Поле «Модуль»"};
+  QStringList values = {cleanInput(m_firstNumberInput->toPlainText()),
+                        cleanInput(m_secondNumberInput->toPlainText()),
+                        cleanInput(m_modulusInput->toPlainText())};
+  for (int index = 0; index < values.size(); ++index)
+    if (!values[index].isEmpty() &&
+        !validateInput(values[index], fields[index]))
+      return;
+  startOperation(
+      "Выражение",
+      [expression, names, values](OperationResult &) {
+        Expression compiled(expression.toStdString());
+        Expression::Variables variables;
+        for (int index = 0; index < values.size(); ++index)
+          if (!values[index].isEmpty())
+            variables.emplace(names[index].toStdString(),
+                              parseOperand(values[index]));
+        return compiled.evaluate(variables);
+      },
+      [this, expression](const OperationResult &result) {
+        appendHistory("%2 = %1", result, {expression});
+      });
 }
 
 void MainWindow::onGcd() {
+  if (m_listMode->isChecked()) {
+    performListOperation("НОД", "gcd");
+    return;
+  }
   QString first = cleanInput(m_firstNumberInput->toPlainText());
   QString second = cleanInput(m_secondNumberInput->toPlainText());
   if (!validateInput(first, "Число 1") || !validateInput(second, "Число 2"))
     return;
-  m_operationLabel->setText("Операция: НОД");
-  try {
-    Integer numberFirst(first.toStdString());
-    Integer numberSecond(second.toStdString());
-    Integer result = gcd(numberFirst, numberSecond);
-    QString resultString = QString::fromStdString(result.toString());
-    m_resultOutput->setText(resultString);
-    appendHistory("НОД(" + first + ", " + second + ") = " + resultString);
-  } catch (const std::exception &exception) {
-    QMessageBox::critical(this, "Ошибка", QString::fromUtf8(exception.what()));
-  }
+  startOperation(
+      "НОД",
+      [first, second](OperationResult &operands) {
+        const Integer &numberFirst = parseOperand(operands, first);
+        const Integer &numberSecond = parseOperand(operands, second);
+        return ResultCache::instance().get(
+            Operation::Gcd, [&] { return gcd(numberFirst, numberSecond); },
+            numberFirst, numberSecond);
+      },
+      [this](const OperationResult &result) {
+        appendHistory("НОД(%1, %2) = %3", result);
+      });
 }
 
 void MainWindow::onLcm() {
+  if (m_listMode->isChecked()) {
+    performListOperation("НОК", "lcm");
+    return;
+  }
   QString first = cleanInput(m_firstNumberInput->toPlainText());
   QString second = cleanInput(m_secondNumberInput->toPlainText());
   if (!validateInput(first, "Число 1") || !validateInput(second, "Число 2"))
     return;
-  m_operationLabel->setText("Операция: НОК");
-  try {
-    Integer numberFirst(first.toStdString());
-    Integer numberSecond(second.toStdString());
-    Integer result = lcm(numberFirst, numberSecond);
-    QString resultString = QString::fromStdString(result.toString());
-    m_resultOutput->setText(resultString);
-    appendHistory("НОК(" + first + ", " + second + ") = " + resultString);
-  } catch (const std::exception &exception) {
-    QMessageBox::critical(this, "Ошибка", QString::fromUtf8(exception.what()));
-  }
+  startOperation(
+      "НОК",
+      [first, second](OperationResult &operands) {
+        const Integer &numberFirst = parseOperand(operands, first);
+        const Integer &numberSecond = parseOperand(operands, second);
+        return ResultCache::instance().get(
+            Operation::Lcm, [&] { return lcm(numberFirst, numberSecond); },
+            numberFirst, numberSecond);
+      },
+      [this](const OperationResult &result) {
+        appendHistory("НОК(%1, %2) = %3", result);
+      });
 }
 
 void MainWindow::onCheckPrime() {
   QString text = cleanInput(m_firstNumberInput->toPlainText());
   if (!validateInput(text, "Число 1"))
     return;
-  m_operationLabel->setText("Операция: Проверка простоты");
-  try {
-    Integer number(text.toStdString());
-    bool prime = isPrime(number);
-    QString answer = prime ? "Простое" : "Составное";
-    m_resultOutput->setText(answer);
-    appendHistory(text + ": " + answer);
-    QMessageBox::information(this, "Результат", answer);
-  } catch (const std::exception &exception) {
-    QMessageBox::critical(this, "Ошибка", QString::fromUtf8(exception.what()));
-  }
+  startOperation(
+      "Проверка простоты",
+      [text](OperationResult &operands) {
+        const Integer &number = parseOperand(operands, text);
+        Integer answer = ResultCache::instance().get(
+            Operation::Prime,
+            [&] { return Integer(isPrime(number) ? 1LL : 0LL); }, number);
+        return QString(answer.isZero() ? "Составное" : "Простое");
+      },
+      [this](const OperationResult &result) {
+        appendHistory("%1: " + result.value, result);
+        QMessageBox::information(this, "Результат", result.value);
+      });
 }
 
 void MainWindow::onClear() {
   m_firstNumberInput->clear();
   m_secondNumberInput->clear();
+  m_modulusInput->clear();
   m_resultOutput->clear();
   m_operationLabel->setText("Операция: -");
 }
@@ -264,4 +819,59 @@ void MainWindow::onCopyResult() {
   QMessageBox::information(this, "Копирование", "Скопировано в буфер обмена.");
 }
 
-void MainWindow::onClearHistory() { m_historyList->clear(); }
+void MainWindow::onSaveResult() {
+  if (!m_lastResult) {
+    QMessageBox::information(this, "Сохранение", "Нет числового результата.");
+    return;
+  }
+  QString path = QFileDialog::getSaveFileName(
+      this, "Сохранить результат", QString(), "Целые числа (*.int)");
+  if (path.isEmpty())
+    return;
+  try {
+    m_lastResult->save(path.toStdString());
+  } catch (const std::exception &exception) {
+    QMessageBox::critical(this, "Ошибка", QString::fromUtf8(exception.what()));
+  }
+}
+
+void MainWindow::loadOperand(QTextEdit *field) {
+  QString path = QFileDialog::getOpenFileName(
+      this, "Загрузить число", QString(), "Целые числа (*.int)");
+  if (!path.isEmpty())
+    field->setPlainText("@" + path);
+}
+
+void MainWindow::onClearHistory() { m_historyModel->clear(); }
+
+void MainWindow::onHistorySelected(const QModelIndex &current) {
+  if (!current.isValid() || m_watcher.isRunning())
+    return;
+  runOperation(
+      "Запись истории",
+      [entry = m_historyModel->entry(current.row())](OperationResult &result) {
+        result.value = HistoryModel::fullText(entry);
+        result.number = entry.result;
+      },
+      nullptr);
+}
+
+void MainWindow::onCopyHistoryEntry() {
+  QModelIndex current = m_historyView->currentIndex();
+  if (!current.isValid() || m_watcher.isRunning())
+    return;
+  runOperation(
+      "Копирование записи",
+      [entry = m_historyModel->entry(current.row())](OperationResult &result) {
+        result.value = HistoryModel::fullText(entry);
+        result.number = entry.result;
+      },
+      [](const OperationResult &result) {
+        QApplication::clipboard()->setText(result.value);
+      });
+}
+
+void MainWindow::onClearCache() {
+  ResultCache::instance().clear();
+  updateCacheStatus();
+}
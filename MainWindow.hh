@@ -1,16 +1,43 @@
 #pragma once
 
+#include <QElapsedTimer>
+#include <QFutureWatcher>
 #include <QMainWindow>
+#include <QStringList>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
 
 class QTextEdit;
+class QCheckBox;
 class QLabel;
-class QListWidget;
+class QLineEdit;
+class QListView;
+class QModelIndex;
+class QProgressBar;
+class QPushButton;
+class HistoryModel;
+class QSpinBox;
+class QTimer;
+class Integer;
+
+struct OperationResult {
+  QString value;
+  QString error;
+  std::shared_ptr<const Integer> number;
+  std::vector<std::shared_ptr<const Integer>> operands;
+  QStringList previews;
+  bool cancelled = false;
+};
 
 class MainWindow : public QMainWindow {
   Q_OBJECT
 
 public:
   explicit MainWindow(QWidget *parent = nullptr);
+  ~MainWindow() override;
 
 private slots:
   void onAdd();
@@ -19,23 +46,72 @@ private slots:
   void onDivide();
   void onModulo();
   void onPower();
+  void onPowerModulo();
+  void onModularInverse();
   void onFactorial();
+  void onSquareRoot();
+  void onRoot();
+  void onCheckPerfectPower();
+  void onFactorize();
+  void onEvaluate();
   void onGcd();
   void onLcm();
   void onCheckPrime();
   void onClear();
   void onCopyResult();
+  void onSaveResult();
   void onClearHistory();
+  void onHistorySelected(const QModelIndex &current);
+  void onCopyHistoryEntry();
+  void onClearCache();
+  void onCancel();
+  void onOperationFinished();
+  void onElapsedTick();
+  void onListModeToggled(bool checked);
 
 private:
   void performBinaryOperation(const QString &name, const QString &symbol);
+  void performListOperation(const QString &name, const QString &symbol);
+  void startOperation(const QString &name,
+                      std::function<QString(OperationResult &)> task,
+                      std::function<void(const OperationResult &)> onSuccess);
+  void startOperation(const QString &name,
+                      std::function<Integer(OperationResult &)> task,
+                      std::function<void(const OperationResult &)> onSuccess);
+  void runOperation(const QString &name,
+                    std::function<void(OperationResult &)> task,
+                    std::function<void(const OperationResult &)> onSuccess);
+  void loadOperand(QTextEdit *field);
+  void setBusy(bool busy);
   bool validateInput(const QString &text, const QString &fieldName);
-  void appendHistory(const QString &entry);
+  void appendHistory(const QString &pattern, const OperationResult &result,
+                     const QStringList &texts = QStringList());
+  void updateCacheStatus();
   QString cleanInput(const QString &raw);
 
   QTextEdit *m_firstNumberInput;
+  QCheckBox *m_listMode;
   QTextEdit *m_secondNumberInput;
+  QTextEdit *m_modulusInput;
+  QLineEdit *m_expressionInput;
   QTextEdit *m_resultOutput;
+  QSpinBox *m_factorTimeLimit;
   QLabel *m_operationLabel;
-  QListWidget *m_historyList;
+  QLabel *m_statusLabel;
+  QProgressBar *m_progressBar;
+  QPushButton *m_cancelButton;
+  QListView *m_historyView;
+  HistoryModel *m_historyModel;
+  QSpinBox *m_historyLimit;
+  QLabel *m_cacheLabel;
+  QList<QPushButton *> m_operationButtons;
+  QList<QPushButton *> m_listButtons;
+
+  QFutureWatcher<OperationResult> m_watcher;
+  std::atomic<bool> m_cancelRequested{false};
+  std::function<void(const OperationResult &)> m_onSuccess;
+  std::shared_ptr<const Integer> m_lastResult;
+  QElapsedTimer m_elapsed;
+  QTimer *m_elapsedTimer;
+  QString m_cachePath;
 };
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class Profiler {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr size_t bucketCount = 40;
+
+  struct Phase {
+    const char *name;
+    std::uint64_t calls;
+    std::uint64_t nanoseconds;
+    std::uint64_t longest;
+    std::uint64_t bytes;
+    std::uint64_t largest;
+    std::uint64_t allocations;
+    std::uint64_t allocatedBytes;
+    std::array<std::uint64_t, bucketCount> histogram;
+  };
+
+  struct Snapshot {
+    std::vector<Phase> phases;
+    std::uint64_t allocations;
+    std::uint64_t allocatedBytes;
+    std::uint64_t events;
+    std::uint64_t droppedEvents;
+  };
+
+  static inline std::atomic<bool> enabled{true};
+  static inline size_t minimumKernelBytes = 256;
+  static inline size_t eventLimit = size_t(1) << 14;
+
+private:
+  struct Event {
+    const char *name;
+    std::uint64_t start;
+    std::uint64_t duration;
+    std::uint64_t bytes;
+    std::uint64_t allocations;
+    std::uint64_t allocatedBytes;
+    std::uint32_t thread;
+  };
+
+  struct Buffer {
+    std::mutex mutex;
+    std::uint32_t thread = 0;
+    const char *active = nullptr;
+    std::atomic<std::uint64_t> allocations{0};
+    std::atomic<std::uint64_t> allocatedBytes{0};
+    std::vector<Phase> phases;
+    std::vector<Event> events;
+    size_t next = 0;
+    std::uint64_t dropped = 0;
+
+    void record(const char *name, Clock::time_point start,
+                Clock::time_point end, size_t bytes,
+                std::uint64_t allocationCount, std::uint64_t allocationBytes) {
+      auto nanoseconds = [](Clock::duration duration) {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+                .count());
+      };
+      std::uint64_t duration = nanoseconds(end - start);
+      Event event{name,  nanoseconds(start - origin), duration,
+                  bytes, allocationCount,             allocationBytes,
+                  thread};
+      std::lock_guard<std::mutex> lock(mutex);
+      Phase &phase = find(phases, name);
+      ++phase.calls;
+      phase.nanoseconds += duration;
+      phase.longest = std::max(phase.longest, duration);
+      phase.bytes += bytes;
+      phase.largest = std::max<std::uint64_t>(phase.largest, bytes);
+      phase.allocations += allocationCount;
+      phase.allocatedBytes += allocationBytes;
+      ++phase.histogram[std::min<size_t>(std::bit_width(duration),
+                                         bucketCount - 1)];
+      if (events.size() < eventLimit) {
+        events.push_back(event);
+        return;
+      }
+      events[next] = event;
+      next = (next + 1) % events.size();
+      ++dropped;
+    }
+  };
+
+public:
+  Profiler(const Profiler &) = delete;
+  Profiler &operator=(const Profiler &) = delete;
+
+  static Profiler &instance() {
+    static Profiler profiler;
+    return profiler;
+  }
+
+  class Scope {
+  public:
+    Scope(const char *name, size_t bytes, size_t minimum = 0)
+        : buffer(nullptr) {
+      if (bytes < minimum || !enabled.load(std::memory_order_relaxed))
+        return;
+      Buffer &current = local();
+      if (current.active && std::string_view(current.active) == name)
+        return;
+      buffer = &current;
+      phase = name;
+      size = bytes;
+      outer = current.active;
+      current.active = name;
+      allocations = current.allocations.load(std::memory_order_relaxed);
+      allocatedBytes = current.allocatedBytes.load(std::memory_order_relaxed);
+      start = Clock::now();
+    }
+
+    ~Scope() {
+      if (!buffer)
+        return;
+      Clock::time_point end = Clock::now();
+      buffer->active = outer;
+      buffer->record(phase, start, end, size,
+                     since(buffer->allocations, allocations),
+                     since(buffer->allocatedBytes, allocatedBytes));
+    }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    static std::uint64_t since(const std::atomic<std::uint64_t> &counter,
+                               std::uint64_t base) {
+      std::uint64_t now = counter.load(std::memory_order_relaxed);
+      return now >= base ? now - base : 0;
+    }
+
+    Buffer *buffer;
+    const char *phase;
+    const char *outer;
+    size_t size;
+    std::uint64_t allocations;
+    std::uint64_t allocatedBytes;
+    Clock::time_point start;
+  };
+
+  static void countAllocation(size_t bytes) {
+    if (!enabled.load(std::memory_order_relaxed))
+      return;
+    Buffer &current = local();
+    add(current.allocations, 1);
+    add(current.allocatedBytes, bytes);
+  }
+
+  Snapshot snapshot() const {
+    Snapshot result{{}, 0, 0, 0, 0};
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const std::shared_ptr<Buffer> &buffer : buffers) {
+      result.allocations +=
+          buffer->allocations.load(std::memory_order_relaxed);
+      result.allocatedBytes +=
+          buffer->allocatedBytes.load(std::memory_order_relaxed);
+      std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+      result.events += buffer->events.size();
+      result.droppedEvents += buffer->dropped;
+      for (const Phase &phase : buffer->phases) {
+        Phase &total = find(result.phases, phase.name);
+        total.calls += phase.calls;
+        total.nanoseconds += phase.nanoseconds;
+        total.longest = std::max(total.longest, phase.longest);
+        total.bytes += phase.bytes;
+        total.largest = std::max(total.largest, phase.largest);
+        total.allocations += phase.allocations;
+        total.allocatedBytes += phase.allocatedBytes;
+        for (size_t bucket = 0; bucket < bucketCount; ++bucket)
+          total.histogram[bucket] += phase.histogram[bucket];
+      }
+    }
+    std::sort(result.phases.begin(), result.phases.end(),
+              [](const Phase &first, const Phase &second) {
+                return first.nanoseconds > second.nanoseconds;
+              });
+    return result;
+  }
+
+  void reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const std::shared_ptr<Buffer> &buffer : buffers) {
+      buffer->allocations.store(0, std::memory_order_relaxed);
+      buffer->allocatedBytes.store(0, std::memory_order_relaxed);
+      std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+      buffer->phases.clear();
+      buffer->events.clear();
+      buffer->next = 0;
+      buffer->dropped = 0;
+    }
+  }
+
+  bool exportTrace(const std::string &path) const {
+    std::vector<Event> events;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (const std::shared_ptr<Buffer> &buffer : buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        events.insert(events.end(), buffer->events.begin(),
+                      buffer->events.end());
+      }
+    }
+    std::sort(events.begin(), events.end(),
+              [](const Event &first, const Event &second) {
+                return first.start < second.start;
+              });
+    std::ofstream output(path, std::ios::trunc);
+    if (!output)
+      return false;
+    output << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    char line[256];
+    for (size_t position = 0; position < events.size(); ++position) {
+      const Event &event = events[position];
+      std::snprintf(
+          line, sizeof(line),
+          "%s\n{\"name\":\"%s\",\"cat\":\"integer\",\"ph\":\"X\","
+          "\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{"
+          "\"bytes\":%llu,\"allocations\":%llu,\"allocated\":%llu}}",
+          position ? "," : "", event.name, event.thread,
+          static_cast<double>(event.start) / 1000,
+          static_cast<double>(event.duration) / 1000,
+          static_cast<unsigned long long>(event.bytes),
+          static_cast<unsigned long long>(event.allocations),
+          static_cast<unsigned long long>(event.allocatedBytes));
+      output << line;
+    }
+    output << "\n]}\n";
+    return static_cast<bool>(output.flush());
+  }
+
+private:
+  static inline const Clock::time_point origin = Clock::now();
+
+  Profiler() = default;
+
+  static void add(std::atomic<std::uint64_t> &counter, std::uint64_t value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+                  std::memory_order_relaxed);
+  }
+
+  static Phase &find(std::vector<Phase> &phases, const char *name) {
+    for (Phase &phase : phases)
+      if (std::string_view(phase.name) == name)
+        return phase;
+    phases.push_back(Phase{name, 0, 0, 0, 0, 0, 0, 0, {}});
+    return phases.back();
+  }
+
+  static Buffer &local() {
+    thread_local std::shared_ptr<Buffer> buffer = instance().attach();
+    return *buffer;
+  }
+
+  std::shared_ptr<Buffer> attach() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const std::shared_ptr<Buffer> &buffer : buffers)
+      if (buffer.use_count() == 1)
+        return buffer;
+    buffers.push_back(std::make_shared<Buffer>());
+    buffers.back()->thread = static_cast<std::uint32_t>(buffers.size());
+    return buffers.back();
+  }
+
+  mutable std::mutex mutex;
+  std::vector<std::shared_ptr<Buffer>> buffers;
+};
+
+#ifdef CALCULATOR_PROFILE
+#define PROFILE_JOIN_(first, second) first##second
+#define PROFILE_JOIN(first, second) PROFILE_JOIN_(first, second)
+#define PROFILE_SCOPE(name, bytes)                                            \
+  Profiler::Scope PROFILE_JOIN(profileScope, __LINE__)(name, bytes)
+#define PROFILE_KERNEL(name, bytes)                                           \
+  Profiler::Scope PROFILE_JOIN(profileScope, __LINE__)(                       \
+      name, bytes, Profiler::minimumKernelBytes)
+#define PROFILE_ALLOCATION(bytes) Profiler::countAllocation(bytes)
+#else
+#define PROFILE_SCOPE(name, bytes) static_cast<void>(0)
+#define PROFILE_KERNEL(name, bytes) static_cast<void>(0)
+#define PROFILE_ALLOCATION(bytes) static_cast<void>(0)
+#endif
@@ -0,0 +1,160 @@
+#include "ProfilerPanel.hh"
+
+#include <QCheckBox>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QTimer>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+#include "Profiler.hh"
+
+namespace {
+
+QString formatDuration(double nanoseconds) {
+  if (nanoseconds < 1e3)
+    return QString::number(nanoseconds, 'f', 0) + " нс";
+  if (nanoseconds < 1e6)
+    return QString::number(nanoseconds / 1e3, 'f', 1) + " мкс";
+  if (nanoseconds < 1e9)
+    return QString::number(nanoseconds / 1e6, 'f', 1) + " мс";
+  return QString::number(nanoseconds / 1e9, 'f', 2) + " с";
+}
+
+QString formatBytes(double bytes) {
+  if (bytes < 1024)
+    return QString::number(bytes, 'f', 0) + " Б";
+  if (bytes < 1024 * 1024)
+    return QString::number(bytes / 1024, 'f', 1) + " КБ";
+  return QString::number(bytes / (1024 * 1024), 'f', 1) + " МБ";
+}
+
+double percentile(const Profiler::Phase &phase, double fraction) {
+  std::uint64_t target =
+      static_cast<std::uint64_t>(fraction * static_cast<double>(phase.calls));
+  std::uint64_t seen = 0;
+  for (size_t bucket = 0; bucket < Profiler::bucketCount; ++bucket) {
+    seen += phase.histogram[bucket];
+    if (seen > target)
+      return static_cast<double>(
+          std::min<std::uint64_t>(std::uint64_t(1) << bucket, phase.longest));
+  }
+  return static_cast<double>(phase.longest);
+}
+
+QString histogram(const Profiler::Phase &phase, QString &details) {
+  static const QString levels = "▁▂▃▄▅▆▇█";
+  size_t first = Profiler::bucketCount, last = 0;
+  std::uint64_t peak = 0;
+  for (size_t bucket = 0; bucket < Profiler::bucketCount; ++bucket) {
+    if (!phase.histogram[bucket])
+      continue;
+    first = std::min(first, bucket);
+    last = bucket;
+    peak = std::max(peak, phase.histogram[bucket]);
+  }
+  QString bars;
+  for (size_t bucket = first; bucket <= last && peak; ++bucket) {
+    std::uint64_t count = phase.histogram[bucket];
+    bars += count ? levels[static_cast<int>(count * 7 / peak)]
+                  : QChar(' ');
+    if (count)
+      details += "≤ " +
+                 formatDuration(static_cast<double>(std::uint64_t(1)
+                                                    << bucket)) +
+                 ": " + QString::number(count) + "\n";
+  }
+  details.chop(1);
+  return bars;
+}
+
+} // namespace
+
+ProfilerPanel::ProfilerPanel(QWidget *parent)
+    : QDockWidget("Профилирование", parent) {
+  setObjectName("profilerPanel");
+  auto *content = new QWidget;
+  auto *layout = new QVBoxLayout(content);
+
+  m_phases = new QTreeWidget;
+  m_phases->setRootIsDecorated(false);
+  m_phases->setHeaderLabels({"Фаза", "Вызовы", "Всего", "Среднее", "p50",
+                             "p99", "Макс.", "Размер", "Макс. размер",
+                             "Аллокации", "Гистограмма"});
+  layout->addWidget(m_phases);
+
+  m_summaryLabel = new QLabel;
+  layout->addWidget(m_summaryLabel);
+
+  auto *buttons = new QHBoxLayout;
+  m_recording = new QCheckBox("Запись");
+  m_recording->setChecked(Profiler::enabled.load());
+  auto *buttonReset = new QPushButton("Сбросить");
+  auto *buttonExport = new QPushButton("Экспорт трассы…");
+  buttons->addWidget(m_recording);
+  buttons->addStretch();
+  buttons->addWidget(buttonReset);
+  buttons->addWidget(buttonExport);
+  layout->addLayout(buttons);
+  setWidget(content);
+
+  m_refreshTimer = new QTimer(this);
+  m_refreshTimer->setInterval(500);
+  m_refreshTimer->start();
+
+  connect(m_refreshTimer, &QTimer::timeout, this, &ProfilerPanel::onRefresh);
+  connect(m_recording, &QCheckBox::toggled, this,
+          [](bool checked) { Profiler::enabled.store(checked); });
+  connect(buttonReset, &QPushButton::clicked, this, &ProfilerPanel::onReset);
+  connect(buttonExport, &QPushButton::clicked, this,
+          &ProfilerPanel::onExportTrace);
+}
+
+void ProfilerPanel::onRefresh() {
+  if (!isVisible())
+    return;
+  Profiler::Snapshot snapshot = Profiler::instance().snapshot();
+  m_phases->clear();
+  for (const Profiler::Phase &phase : snapshot.phases) {
+    double calls = static_cast<double>(phase.calls);
+    QString details;
+    auto *item = new QTreeWidgetItem(m_phases);
+    item->setText(0, QString::fromUtf8(phase.name));
+    item->setText(1, QString::number(phase.calls));
+    item->setText(2, formatDuration(static_cast<double>(phase.nanoseconds)));
+    item->setText(3, formatDuration(static_cast<double>(phase.nanoseconds) /
+                                    calls));
+    item->setText(4, formatDuration(percentile(phase, 0.5)));
+    item->setText(5, formatDuration(percentile(phase, 0.99)));
+    item->setText(6, formatDuration(static_cast<double>(phase.longest)));
+    item->setText(7, formatBytes(static_cast<double>(phase.bytes) / calls));
+    item->setText(8, formatBytes(static_cast<double>(phase.largest)));
+    double allocated = static_cast<double>(phase.allocatedBytes);
+    item->setText(9, QString::number(phase.allocations) + " / " +
+                         formatBytes(allocated));
+    item->setText(10, histogram(phase, details));
+    item->setToolTip(10, details);
+  }
+  m_summaryLabel->setText(
+      "Аллокаций: " + QString::number(snapshot.allocations) + " (" +
+      formatBytes(static_cast<double>(snapshot.allocatedBytes)) +
+      "), событий: " + QString::number(snapshot.events) +
+      ", вытеснено: " + QString::number(snapshot.droppedEvents));
+}
+
+void ProfilerPanel::onReset() {
+  Profiler::instance().reset();
+  onRefresh();
+}
+
+void ProfilerPanel::onExportTrace() {
+  QString path = QFileDialog::getSaveFileName(
+      this, "Экспорт трассы", "trace.json", "Chrome trace (*.json)");
+  if (path.isEmpty())
+    return;
+  if (!Profiler::instance().exportTrace(path.toStdString()))
+    QMessageBox::critical(this, "Ошибка", "Не удалось записать " + path);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QDockWidget>
+
+class QCheckBox;
+class QLabel;
+class QTimer;
+class QTreeWidget;
+
+class ProfilerPanel : public QDockWidget {
+  Q_OBJECT
+
+public:
+  explicit ProfilerPanel(QWidget *parent = nullptr);
+
+private slots:
+  void onRefresh();
+  void onReset();
+  void onExportTrace();
+
+private:
+  QTreeWidget *m_phases;
+  QLabel *m_summaryLabel;
+  QCheckBox *m_recording;
+  QTimer *m_refreshTimer;
+};
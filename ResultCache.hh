@@ -0,0 +1,323 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Integer.hh"
+
+enum class Operation : std::uint8_t {
+  Multiply,
+  Divide,
+  Modulo,
+  Power,
+  PowerModulo,
+  ModularInverse,
+  Factorial,
+  SquareRoot,
+  Root,
+  PerfectPower,
+  Gcd,
+  Lcm,
+  Prime,
+  Count
+};
+
+class ResultCache {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Statistics {
+    std::uint64_t hits;
+    std::uint64_t misses;
+    size_t entries;
+    size_t bytes;
+  };
+
+  static inline Clock::duration minimumCost = std::chrono::microseconds(50);
+  static inline size_t minimumLimbs = 64;
+
+  explicit ResultCache(size_t capacity)
+      : limit(capacity), used(0), hits(0), misses(0) {}
+
+  ResultCache(const ResultCache &) = delete;
+  ResultCache &operator=(const ResultCache &) = delete;
+
+  static ResultCache &instance() {
+    static ResultCache cache(size_t(256) << 20);
+    return cache;
+  }
+
+  template <typename Compute, typename... Operands>
+  Integer get(Operation operation, const Compute &compute,
+              const Operands &...operands) {
+    std::array<const Integer *, sizeof...(Operands)> list{&operands...};
+    if (isCheap(operation, list.data(), list.size()))
+      return compute();
+    std::uint64_t hash = hashOf(operation, list.data(), list.size());
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto [first, last] = index.equal_range(hash);
+      for (; first != last; ++first) {
+        auto entry = first->second;
+        if (matches(*entry, operation, list.data(), list.size())) {
+          ++hits;
+          entries.splice(entries.begin(), entries, entry);
+          return entry->result;
+        }
+      }
+      ++misses;
+    }
+    Clock::time_point start = Clock::now();
+    Integer result = compute();
+    if (Clock::now() - start >= minimumCost)
+      insert(Entry{operation, hash, {operands...}, result, 0});
+    return result;
+  }
+
+  Statistics statistics() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return {hits, misses, entries.size(), used};
+  }
+
+  size_t capacity() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return limit;
+  }
+
+  void setCapacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex);
+    limit = capacity;
+    evict();
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    used = 0;
+  }
+
+  bool save(const std::string &path) const {
+    std::string temporary = path + ".tmp";
+    {
+      std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+      if (!output)
+        return false;
+      output.write(magic, sizeof(magic));
+      writeWord(output, byteOrderMark);
+      writeWord(output, version);
+      std::lock_guard<std::mutex> lock(mutex);
+      for (auto entry = entries.rbegin(); entry != entries.rend(); ++entry) {
+        output.put(static_cast<char>(entry->operation));
+        output.put(static_cast<char>(entry->operands.size()));
+        for (const Integer &operand : entry->operands)
+          writeInteger(output, operand);
+        writeInteger(output, entry->result);
+      }
+      if (!output.flush())
+        return false;
+    }
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+  }
+
+  bool load(const std::string &path) {
+    std::ifstream input(path, std::ios::binary | std::ios::ate);
+    if (!input)
+      return false;
+    std::uint64_t remaining = static_cast<std::uint64_t>(input.tellg());
+    input.seekg(0);
+    char header[sizeof(magic)];
+    std::uint64_t mark = 0, format = 0;
+    if (!input.read(header, sizeof(header)) ||
+        !std::equal(header, header + sizeof(header), magic) ||
+        !readWord(input, mark) || mark != byteOrderMark)
+      throw std::runtime_error("Not a result cache file: " + path);
+    if (!readWord(input, format) || format != version)
+      throw std::runtime_error("Unsupported result cache version: " + path);
+    remaining -= sizeof(magic) + sizeof(mark) + sizeof(format);
+    std::vector<Entry> loaded;
+    for (;;) {
+      int operation = input.get();
+      if (operation == std::char_traits<char>::eof())
+        break;
+      int count = input.get();
+      if (count == std::char_traits<char>::eof())
+        throw std::runtime_error("Truncated result cache file: " + path);
+      if (operation >= static_cast<int>(Operation::Count) ||
+          count > maximumOperands)
+        throw std::runtime_error("Corrupt result cache file: " + path);
+      Entry entry{static_cast<Operation>(operation), 0, {}, {}, 0};
+      entry.operands.resize(count);
+      remaining -= 2;
+      for (Integer &operand : entry.operands)
+        if (!readInteger(input, operand, remaining))
+          throw std::runtime_error("Truncated result cache file: " + path);
+      if (!readInteger(input, entry.result, remaining))
+        throw std::runtime_error("Truncated result cache file: " + path);
+      std::vector<const Integer *> list;
+      for (const Integer &operand : entry.operands)
+        list.push_back(&operand);
+      entry.hash = hashOf(entry.operation, list.data(), list.size());
+      loaded.push_back(std::move(entry));
+    }
+    for (Entry &entry : loaded)
+      insert(std::move(entry));
+    return true;
+  }
+
+private:
+  struct Entry {
+    Operation operation;
+    std::uint64_t hash;
+    std::vector<Integer> operands;
+    Integer result;
+    size_t bytes;
+  };
+
+  using Iterator = std::list<Entry>::iterator;
+
+  static constexpr char magic[8] = {'I', 'N', 'T', 'C', 'A', 'C', 'H', 'E'};
+  static constexpr std::uint64_t byteOrderMark = 0x0102030405060708ULL;
+  static constexpr std::uint64_t version = 1;
+  static constexpr int maximumOperands = 3;
+  static constexpr size_t entryOverhead =
+      sizeof(Entry) + 6 * sizeof(void *) + sizeof(std::uint64_t);
+
+  static bool isCheap(Operation operation, const Integer *const *operands,
+                      size_t count) {
+    switch (operation) {
+    case Operation::Multiply:
+    case Operation::Divide:
+    case Operation::Modulo:
+    case Operation::SquareRoot:
+    case Operation::Root:
+    case Operation::Gcd:
+    case Operation::Lcm: {
+      size_t limbs = 0;
+      for (size_t position = 0; position < count; ++position)
+        limbs += operands[position]->limbs.size();
+      return limbs < minimumLimbs;
+    }
+    default:
+      return false;
+    }
+  }
+
+  static std::uint64_t mix(std::uint64_t hash, std::uint64_t value) {
+    hash = (hash ^ value) * 0x9e3779b97f4a7c15ULL;
+    return hash ^ (hash >> 29);
+  }
+
+  static std::uint64_t hashOf(Operation operation,
+                              const Integer *const *operands, size_t count) {
+    std::uint64_t hash = mix(0, static_cast<std::uint64_t>(operation));
+    for (size_t position = 0; position < count; ++position) {
+      const Integer &operand = *operands[position];
+      hash = mix(hash, operand.limbs.size() << 1 | operand.negative);
+      for (Integer::Limb limb : operand.limbs)
+        hash = mix(hash, limb);
+    }
+    return hash;
+  }
+
+  static bool matches(const Entry &entry, Operation operation,
+                      const Integer *const *operands, size_t count) {
+    if (entry.operation != operation || entry.operands.size() != count)
+      return false;
+    for (size_t position = 0; position < count; ++position)
+      if (!(entry.operands[position] == *operands[position]))
+        return false;
+    return true;
+  }
+
+  static size_t footprint(const Integer &value) {
+    return sizeof(Integer) + value.limbs.size() * sizeof(Integer::Limb);
+  }
+
+  void insert(Entry entry) {
+    entry.bytes = entryOverhead + footprint(entry.result);
+    for (const Integer &operand : entry.operands)
+      entry.bytes += footprint(operand);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (entry.bytes > limit)
+      return;
+    std::vector<const Integer *> list;
+    for (const Integer &operand : entry.operands)
+      list.push_back(&operand);
+    auto [first, last] = index.equal_range(entry.hash);
+    for (; first != last; ++first)
+      if (matches(*first->second, entry.operation, list.data(), list.size()))
+        return;
+    used += entry.bytes;
+    entries.push_front(std::move(entry));
+    index.emplace(entries.front().hash, entries.begin());
+    evict();
+  }
+
+  void evict() {
+    while (used > limit && !entries.empty()) {
+      Entry &victim = entries.back();
+      auto [first, last] = index.equal_range(victim.hash);
+      for (; first != last; ++first)
+        if (&*first->second == &victim) {
+          index.erase(first);
+          break;
+        }
+      used -= victim.bytes;
+      entries.pop_back();
+    }
+  }
+
+  static void writeWord(std::ostream &output, std::uint64_t word) {
+    output.write(reinterpret_cast<const char *>(&word), sizeof(word));
+  }
+
+  static bool readWord(std::istream &input, std::uint64_t &word) {
+    return static_cast<bool>(
+        input.read(reinterpret_cast<char *>(&word), sizeof(word)));
+  }
+
+  static void writeInteger(std::ostream &output, const Integer &value) {
+    writeWord(output, value.limbs.size() << 1 | value.negative);
+    output.write(reinterpret_cast<const char *>(value.limbs.data()),
+                 value.limbs.size() * sizeof(Integer::Limb));
+  }
+
+  static bool readInteger(std::istream &input, Integer &value,
+                          std::uint64_t &remaining) {
+    std::uint64_t header = 0;
+    if (remaining < sizeof(header) || !readWord(input, header))
+      return false;
+    remaining -= sizeof(header);
+    std::uint64_t size = header >> 1;
+    if (size > remaining / sizeof(Integer::Limb))
+      return false;
+    remaining -= size * sizeof(Integer::Limb);
+    value.limbs.resizeUninitialized(size);
+    if (!input.read(reinterpret_cast<char *>(value.limbs.data()),
+                    size * sizeof(Integer::Limb)))
+      return false;
+    value.removeLeadingZeros();
+    value.negative = (header & 1) && !value.limbs.empty();
+    return true;
+  }
+
+  mutable std::mutex mutex;
+  std::list<Entry> entries;
+  std::unordered_multimap<std::uint64_t, Iterator> index;
+  size_t limit;
+  size_t used;
+  std::uint64_t hits;
+  std::uint64_t misses;
+};
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class ThreadPool {
+public:
+  using Task = std::function<void()>;
+
+  explicit ThreadPool(size_t threads) : pending(0), stopping(false) {
+    for (size_t index = 0; index <= threads; ++index)
+      queues.push_back(std::make_unique<Queue>());
+    for (size_t index = 0; index < threads; ++index)
+      workers.emplace_back([this, index] { work(index); });
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(sleepMutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &worker : workers)
+      worker.join();
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  size_t size() const { return workers.size(); }
+
+  void submit(Task task) {
+    Queue &queue = *queues[homeQueue()];
+    {
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.tasks.push_back(std::move(task));
+    }
+    pending.fetch_add(1);
+    { std::lock_guard<std::mutex> lock(sleepMutex); }
+    wake.notify_one();
+  }
+
+  bool runPending() {
+    Task task;
+    if (!take(homeQueue(), task))
+      return false;
+    task();
+    return true;
+  }
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  size_t homeQueue() const {
+    return currentPool == this ? currentIndex : workers.size();
+  }
+
+  bool take(size_t home, Task &task) {
+    {
+      Queue &own = *queues[home];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.tasks.empty()) {
+        task = std::move(own.tasks.back());
+        own.tasks.pop_back();
+        pending.fetch_sub(1);
+        return true;
+      }
+    }
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+      Queue &victim = *queues[(home + offset) % queues.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.tasks.empty()) {
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        pending.fetch_sub(1);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void work(size_t index) {
+    currentPool = this;
+    currentIndex = index;
+    Task task;
+    for (;;) {
+      if (take(index, task)) {
+        task();
+        task = nullptr;
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleepMutex);
+      wake.wait(lock, [this] { return stopping || pending.load() > 0; });
+      if (stopping)
+        return;
+    }
+  }
+
+  static inline thread_local const ThreadPool *currentPool = nullptr;
+  static inline thread_local size_t currentIndex = 0;
+
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::vector<std::thread> workers;
+  std::atomic<size_t> pending;
+  std::mutex sleepMutex;
+  std::condition_variable wake;
+  bool stopping;
+};
+
+class TaskGroup {
+public:
+  explicit TaskGroup(ThreadPool &threadPool) : pool(threadPool), remaining(0) {}
+  ~TaskGroup() { finish(); }
+
+  TaskGroup(const TaskGroup &) = delete;
+  TaskGroup &operator=(const TaskGroup &) = delete;
+
+  void run(ThreadPool::Task task) {
+    remaining.fetch_add(1);
+    pool.submit([this, task = std::move(task)] {
+      try {
+        task();
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error)
+          error = std::current_exception();
+      }
+      remaining.fetch_sub(1, std::memory_order_release);
+    });
+  }
+
+  void wait() {
+    finish();
+    if (error)
+      std::rethrow_exception(std::exchange(error, nullptr));
+  }
+
+private:
+  void finish() {
+    while (remaining.load(std::memory_order_acquire) > 0)
+      if (!pool.runPending())
+        std::this_thread::yield();
+  }
+
+  ThreadPool &pool;
+  std::atomic<size_t> remaining;
+  std::mutex errorMutex;
+  std::exception_ptr error;
+};
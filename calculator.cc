@@ -1,8 +1,53 @@
 #include <QApplication>
 
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+#include "Batch.hh"
+#include "Integer.hh"
 #include "MainWindow.hh"
+#include "Profiler.hh"
+#include "ResultCache.hh"
 
 int main(int argc, char **argv) {
+  int argument = 1;
+  const char *cachePath = nullptr;
+  const char *tracePath = nullptr;
+  for (; argc > argument + 1; argument += 2) {
+    if (std::strcmp(argv[argument], "--threads") == 0) {
+      const char *text = argv[argument + 1];
+      const char *end = text + std::strlen(text);
+      unsigned count = 0;
+      auto [last, error] = std::from_chars(text, end, count);
+      if (error != std::errc() || last != end || count == 0) {
+        std::fprintf(stderr, "Invalid thread count: %s\n", text);
+        return 1;
+      }
+      Integer::setThreadCount(count);
+    } else if (std::strcmp(argv[argument], "--cache") == 0)
+      cachePath = argv[argument + 1];
+    else if (std::strcmp(argv[argument], "--trace") == 0)
+      tracePath = argv[argument + 1];
+    else
+      break;
+  }
+  if (argc > argument && std::strcmp(argv[argument], "--batch") == 0) {
+    try {
+      if (cachePath)
+        ResultCache::instance().load(cachePath);
+    } catch (const std::exception &exception) {
+      std::fprintf(stderr, "Ignoring cache: %s\n", exception.what());
+    }
+    int status = runBatch(argc > argument + 1 ? argv[argument + 1] : "-");
+    if (cachePath && !ResultCache::instance().save(cachePath))
+      std::fprintf(stderr, "Cannot save cache to %s\n", cachePath);
+    if (tracePath && !Profiler::instance().exportTrace(tracePath))
+      std::fprintf(stderr, "Cannot save trace to %s\n", tracePath);
+    return status;
+  }
+
   QApplication application(argc, argv);
   MainWindow window;
   window.show();
@@ -0,0 +1,493 @@
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef CALCULATOR_BENCH_GMP
+#include <gmp.h>
+#endif
+
+#include "Integer.hh"
+
+namespace {
+
+std::atomic<size_t> allocationCount{0};
+std::atomic<size_t> allocationBytes{0};
+
+void *countedAllocate(size_t size) {
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  allocationBytes.fetch_add(size, std::memory_order_relaxed);
+  return std::malloc(size ? size : 1);
+}
+
+} // namespace
+
+void *operator new(size_t size) {
+  if (void *pointer = countedAllocate(size))
+    return pointer;
+  throw std::bad_alloc();
+}
+void *operator new[](size_t size) { return operator new(size); }
+[[gnu::noinline]] void operator delete(void *pointer) noexcept {
+  std::free(pointer);
+}
+void operator delete[](void *pointer) noexcept { operator delete(pointer); }
+void operator delete(void *pointer, size_t) noexcept {
+  operator delete(pointer);
+}
+void operator delete[](void *pointer, size_t) noexcept {
+  operator delete(pointer);
+}
+
+namespace {
+
+struct Options {
+  size_t maxDigits = 1000000;
+  double minTime = 0.2;
+  std::string filter;
+  std::string jsonPath;
+};
+
+struct Measurement {
+  std::string name;
+  std::string engine;
+  size_t digits;
+  size_t iterations;
+  double nanoseconds;
+  double allocations;
+  double bytes;
+};
+
+using Inputs = std::function<std::vector<std::string>(size_t digits,
+                                                      size_t &actualDigits)>;
+using Factory = std::function<std::function<void()>(
+    const std::vector<std::string> &inputs, std::string &result)>;
+
+struct Case {
+  std::string name;
+  size_t maxDigits;
+  Inputs inputs;
+  Factory integer;
+  Factory gmp = nullptr;
+};
+
+const std::mt19937_64::result_type generatorSeed = 20240229;
+std::mt19937_64 generator(generatorSeed);
+
+std::string randomDigits(size_t digits) {
+  std::string text(digits, '0');
+  for (char &character : text)
+    character = static_cast<char>('0' + generator() % 10);
+  text[0] = static_cast<char>('1' + generator() % 9);
+  return text;
+}
+
+Inputs randomOperands(std::vector<size_t> scales) {
+  return [scales](size_t digits, size_t &actualDigits) {
+    actualDigits = digits;
+    std::vector<std::string> operands;
+    for (size_t scale : scales)
+      operands.push_back(randomDigits(scale * digits));
+    return operands;
+  };
+}
+
+unsigned long factorialArgument(size_t digits) {
+  unsigned long argument = 1;
+  while (std::lgamma(static_cast<double>(argument) + 1) / std::log(10.0) <
+         static_cast<double>(digits))
+    argument = argument < 16 ? argument + 1 : argument + argument / 16;
+  return argument;
+}
+
+unsigned mersenneExponent(size_t digits) {
+  static const unsigned exponents[] = {31, 61, 89, 107, 127, 521, 607,
+                                       1279, 2203, 2281, 3217, 4253, 4423,
+                                       9689, 9941, 11213, 19937, 21701, 23209};
+  unsigned best = exponents[0];
+  for (unsigned exponent : exponents)
+    if (exponent * 0.30103 <= digits)
+      best = exponent;
+  return best;
+}
+
+Measurement measure(const std::string &name, const std::string &engine,
+                    size_t digits, const std::function<void()> &operation,
+                    double minTime) {
+  operation();
+  size_t iterations = 0;
+  size_t allocationsBefore = allocationCount.load();
+  size_t bytesBefore = allocationBytes.load();
+  auto start = std::chrono::steady_clock::now();
+  double elapsed = 0;
+  do {
+    operation();
+    ++iterations;
+    elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            start)
+                  .count();
+  } while (elapsed < minTime);
+  return {name,
+          engine,
+          digits,
+          iterations,
+          elapsed * 1e9 / static_cast<double>(iterations),
+          static_cast<double>(allocationCount.load() - allocationsBefore) /
+              static_cast<double>(iterations),
+          static_cast<double>(allocationBytes.load() - bytesBefore) /
+              static_cast<double>(iterations)};
+}
+
+std::vector<Case> integerCases() {
+  std::vector<Case> cases;
+  auto evaluate = [](auto operation) -> Factory {
+    return [operation](const std::vector<std::string> &inputs,
+                       std::string &result) {
+      std::vector<Integer> operands(inputs.begin(), inputs.end());
+      result = operation(operands).toString();
+      return std::function<void()>([=] {
+        volatile bool sink = operation(operands).isZero();
+        (void)sink;
+      });
+    };
+  };
+  cases.push_back({"add", 1000000, randomOperands({1, 1}),
+                   evaluate([](const std::vector<Integer> &operands) {
+                     return operands[0] + operands[1];
+                   })});
+  cases.push_back({"multiply", 1000000, randomOperands({1, 1}),
+                   evaluate([](const std::vector<Integer> &operands) {
+                     return operands[0] * operands[1];
+                   })});
+  cases.push_back({"square", 1000000, randomOperands({1}),
+                   evaluate([](const std::vector<Integer> &operands) {
+                     return square(operands[0]);
+                   })});
+  cases.push_back(
+      {"divide", 1000000, randomOperands({2, 1}),
+       [](const std::vector<std::string> &inputs, std::string &result) {
+         Integer dividend(inputs[0]), divisor(inputs[1]);
+         auto [quotient, remainder] = divideWithRemainder(dividend, divisor);
+         result = quotient.toString() + " " + remainder.toString();
+         return std::function<void()>([=] {
+           volatile bool sink =
+               divideWithRemainder(dividend, divisor).second.isZero();
+           (void)sink;
+         });
+       }});
+  cases.push_back({"gcd", 100000, randomOperands({1, 1}),
+                   evaluate([](const std::vector<Integer> &operands) {
+                     return gcd(operands[0], operands[1]);
+                   })});
+  cases.push_back({"power", 100000,
+                   [](size_t digits, size_t &actualDigits) {
+                     actualDigits = digits;
+                     return std::vector<std::string>{
+                         randomDigits(10),
+                         std::to_string(std::max<size_t>(1, digits / 10))};
+                   },
+                   evaluate([](const std::vector<Integer> &operands) {
+                     return power(operands[0], operands[1]);
+                   })});
+  cases.push_back({"factorial", 1000000,
+                   [](size_t digits, size_t &actualDigits) {
+                     actualDigits = digits;
+                     return std::vector<std::string>{
+                         std::to_string(factorialArgument(digits))};
+                   },
+                   evaluate([](const std::vector<Integer> &operands) {
+                     return factorial(operands[0]);
+                   })});
+  cases.push_back(
+      {"isPrime", 10000,
+       [](size_t digits, size_t &actualDigits) {
+         unsigned exponent = mersenneExponent(digits);
+         std::string prime =
+             ((Integer(1LL) << exponent) - Integer(1LL)).toString();
+         actualDigits = prime.size();
+         return std::vector<std::string>{prime};
+       },
+       [](const std::vector<std::string> &inputs, std::string &result) {
+         Integer prime(inputs[0]);
+         result = isPrime(prime) ? "prime" : "composite";
+         return std::function<void()>([=] {
+           volatile bool sink = isPrime(prime);
+           (void)sink;
+         });
+       }});
+  cases.push_back({"powMod", 1000, randomOperands({1, 1, 1}),
+                   evaluate([](const std::vector<Integer> &operands) {
+                     return powMod(operands[0], operands[1], operands[2]);
+                   })});
+  cases.push_back(
+      {"parse", 1000000, randomOperands({1}),
+       [](const std::vector<std::string> &inputs, std::string &result) {
+         std::string text = inputs[0];
+         result = Integer(text).toString();
+         return std::function<void()>([=] {
+           volatile bool sink = Integer(text).isZero();
+           (void)sink;
+         });
+       }});
+  cases.push_back(
+      {"toString", 1000000, randomOperands({1}),
+       [](const std::vector<std::string> &inputs, std::string &result) {
+         Integer value(inputs[0]);
+         value.toString(result);
+         return std::function<void()>([=] {
+           std::string text;
+           value.toString(text);
+         });
+       }});
+  return cases;
+}
+
+#ifdef CALCULATOR_BENCH_GMP
+void *gmpAllocate(size_t size) { return countedAllocate(size); }
+void *gmpReallocate(void *pointer, size_t, size_t size) {
+  allocationCount.fetch_add(1, std::memory_order_relaxed);
+  allocationBytes.fetch_add(size, std::memory_order_relaxed);
+  return std::realloc(pointer, size);
+}
+void gmpFree(void *pointer, size_t) { std::free(pointer); }
+
+struct GmpInteger {
+  mpz_t value;
+  GmpInteger() { mpz_init(value); }
+  explicit GmpInteger(const std::string &text) {
+    mpz_init_set_str(value, text.c_str(), 10);
+  }
+  GmpInteger(const GmpInteger &other) { mpz_init_set(value, other.value); }
+  GmpInteger &operator=(const GmpInteger &) = delete;
+  ~GmpInteger() { mpz_clear(value); }
+
+  std::string toString() const {
+    std::vector<char> text(mpz_sizeinbase(value, 10) + 2);
+    mpz_get_str(text.data(), 10, value);
+    return text.data();
+  }
+};
+
+using GmpOperands = std::vector<GmpInteger>;
+
+void attachGmpCases(std::vector<Case> &cases) {
+  mp_set_memory_functions(gmpAllocate, gmpReallocate, gmpFree);
+  auto evaluate = [](auto operation) -> Factory {
+    return [operation](const std::vector<std::string> &inputs,
+                       std::string &result) {
+      auto operands =
+          std::make_shared<GmpOperands>(inputs.begin(), inputs.end());
+      GmpInteger value;
+      operation(value.value, *operands);
+      result = value.toString();
+      return std::function<void()>([=] {
+        GmpInteger value;
+        operation(value.value, *operands);
+      });
+    };
+  };
+  for (Case &benchmark : cases) {
+    if (benchmark.name == "add")
+      benchmark.gmp = evaluate([](mpz_t result, const GmpOperands &operands) {
+        mpz_add(result, operands[0].value, operands[1].value);
+      });
+    else if (benchmark.name == "multiply")
+      benchmark.gmp = evaluate([](mpz_t result, const GmpOperands &operands) {
+        mpz_mul(result, operands[0].value, operands[1].value);
+      });
+    else if (benchmark.name == "square")
+      benchmark.gmp = evaluate([](mpz_t result, const GmpOperands &operands) {
+        mpz_mul(result, operands[0].value, operands[0].value);
+      });
+    else if (benchmark.name == "gcd")
+      benchmark.gmp = evaluate([](mpz_t result, const GmpOperands &operands) {
+        mpz_gcd(result, operands[0].value, operands[1].value);
+      });
+    else if (benchmark.name == "divide")
+      benchmark.gmp = [](const std::vector<std::string> &inputs,
+                         std::string &result) {
+        auto dividend = std::make_shared<GmpInteger>(inputs[0]);
+        auto divisor = std::make_shared<GmpInteger>(inputs[1]);
+        GmpInteger quotient, remainder;
+        mpz_tdiv_qr(quotient.value, remainder.value, dividend->value,
+                    divisor->value);
+        result = quotient.toString() + " " + remainder.toString();
+        return std::function<void()>([=] {
+          GmpInteger quotient, remainder;
+          mpz_tdiv_qr(quotient.value, remainder.value, dividend->value,
+                      divisor->value);
+        });
+      };
+    else if (benchmark.name == "power")
+      benchmark.gmp = evaluate([](mpz_t result, const GmpOperands &operands) {
+        mpz_pow_ui(result, operands[0].value, mpz_get_ui(operands[1].value));
+      });
+    else if (benchmark.name == "factorial")
+      benchmark.gmp = evaluate([](mpz_t result, const GmpOperands &operands) {
+        mpz_fac_ui(result, mpz_get_ui(operands[0].value));
+      });
+    else if (benchmark.name == "isPrime")
+      benchmark.gmp = [](const std::vector<std::string> &inputs,
+                         std::string &result) {
+        auto prime = std::make_shared<GmpInteger>(inputs[0]);
+        result =
+            mpz_probab_prime_p(prime->value, 25) ? "prime" : "composite";
+        return std::function<void()>([=] {
+          volatile int sink = mpz_probab_prime_p(prime->value, 25);
+          (void)sink;
+        });
+      };
+    else if (benchmark.name == "powMod")
+      benchmark.gmp = evaluate([](mpz_t result, const GmpOperands &operands) {
+        mpz_powm(result, operands[0].value, operands[1].value,
+                 operands[2].value);
+      });
+    else if (benchmark.name == "parse")
+      benchmark.gmp = [](const std::vector<std::string> &inputs,
+                         std::string &result) {
+        std::string text = inputs[0];
+        result = GmpInteger(text).toString();
+        return std::function<void()>([=] { GmpInteger value(text); });
+      };
+    else if (benchmark.name == "toString")
+      benchmark.gmp = [](const std::vector<std::string> &inputs,
+                         std::string &result) {
+        auto value = std::make_shared<GmpInteger>(inputs[0]);
+        auto buffer =
+            std::make_shared<std::vector<char>>(inputs[0].size() + 2);
+        mpz_get_str(buffer->data(), 10, value->value);
+        result = buffer->data();
+        return std::function<void()>(
+            [=] { mpz_get_str(buffer->data(), 10, value->value); });
+      };
+  }
+}
+#endif
+
+void writeJson(const std::string &path,
+               const std::vector<Measurement> &measurements) {
+  std::FILE *file =
+      path == "-" ? stdout : std::fopen(path.c_str(), "w");
+  if (!file) {
+    std::fprintf(stderr, "Cannot open %s\n", path.c_str());
+    return;
+  }
+  std::fprintf(file, "{\n  \"context\": {\"limb_bits\": %d, \"gmp\": %s},\n",
+               Integer::limbBits,
+#ifdef CALCULATOR_BENCH_GMP
+               "true"
+#else
+               "false"
+#endif
+  );
+  std::fprintf(file, "  \"benchmarks\": [\n");
+  for (size_t index = 0; index < measurements.size(); ++index) {
+    const Measurement &measurement = measurements[index];
+    std::fprintf(file,
+                 "    {\"name\": \"%s/%zu/%s\", \"operation\": \"%s\", "
+                 "\"engine\": \"%s\", \"digits\": %zu, \"iterations\": %zu, "
+                 "\"ns_per_op\": %.1f, \"allocations_per_op\": %.2f, "
+                 "\"bytes_per_op\": %.1f}%s\n",
+                 measurement.name.c_str(), measurement.digits,
+                 measurement.engine.c_str(), measurement.name.c_str(),
+                 measurement.engine.c_str(), measurement.digits,
+                 measurement.iterations, measurement.nanoseconds,
+                 measurement.allocations, measurement.bytes,
+                 index + 1 < measurements.size() ? "," : "");
+  }
+  std::fprintf(file, "  ]\n}\n");
+  if (file != stdout)
+    std::fclose(file);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  for (int index = 1; index < argc; ++index) {
+    std::string argument = argv[index];
+    auto value = [&]() -> std::string {
+      if (index + 1 >= argc) {
+        std::fprintf(stderr, "Missing value for %s\n", argument.c_str());
+        std::exit(2);
+      }
+      return argv[++index];
+    };
+    if (argument == "--max-digits")
+      options.maxDigits = std::stoull(value());
+    else if (argument == "--min-time")
+      options.minTime = std::stod(value());
+    else if (argument == "--filter")
+      options.filter = value();
+    else if (argument == "--json")
+      options.jsonPath = value();
+    else if (argument == "--threads")
+      Integer::setThreadCount(std::stoull(value()));
+    else {
+      std::fprintf(stderr,
+                   "Usage: %s [--max-digits N] [--min-time SECONDS] "
+                   "[--filter NAME] [--json FILE|-] [--threads N]\n",
+                   argv[0]);
+      return 2;
+    }
+  }
+
+  std::vector<Case> cases = integerCases();
+#ifdef CALCULATOR_BENCH_GMP
+  attachGmpCases(cases);
+#endif
+
+  std::vector<Measurement> measurements;
+  size_t mismatches = 0;
+  FILE *table = options.jsonPath == "-" ? stderr : stdout;
+  std::fprintf(table, "%-10s %-8s %9s %10s %16s %12s %14s\n", "operation",
+               "engine", "digits", "iterations", "ns/op", "allocs/op",
+               "bytes/op");
+  for (const Case &benchmark : cases) {
+    if (!options.filter.empty() &&
+        benchmark.name.find(options.filter) == std::string::npos)
+      continue;
+    generator.seed(generatorSeed);
+    for (size_t digits = 10;
+         digits <= std::min(options.maxDigits, benchmark.maxDigits);
+         digits *= 10) {
+      size_t actualDigits = digits;
+      std::vector<std::string> inputs = benchmark.inputs(digits, actualDigits);
+      std::string results[2];
+      for (int engine = 0; engine < 2; ++engine) {
+        const Factory &factory =
+            engine == 0 ? benchmark.integer : benchmark.gmp;
+        if (!factory)
+          continue;
+        std::function<void()> operation = factory(inputs, results[engine]);
+        Measurement measurement =
+            measure(benchmark.name, engine == 0 ? "Integer" : "gmp",
+                    actualDigits, operation, options.minTime);
+        std::fprintf(table, "%-10s %-8s %9zu %10zu %16.0f %12.1f %14.0f\n",
+                     measurement.name.c_str(), measurement.engine.c_str(),
+                     measurement.digits, measurement.iterations,
+                     measurement.nanoseconds, measurement.allocations,
+                     measurement.bytes);
+        std::fflush(table);
+        measurements.push_back(measurement);
+      }
+      if (benchmark.gmp && results[0] != results[1]) {
+        std::fprintf(stderr, "%s: Integer and gmp disagree at %zu digits\n",
+                     benchmark.name.c_str(), actualDigits);
+        ++mismatches;
+      }
+    }
+  }
+
+  if (!options.jsonPath.empty())
+    writeJson(options.jsonPath, measurements);
+  return mismatches ? 1 : 0;
+}
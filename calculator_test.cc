@@ -0,0 +1,598 @@
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Expression.hh"
+#include "Integer.hh"
+#include "LimbKernels.hh"
+#include "ResultCache.hh"
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const std::string &description) {
+  if (condition)
+    return;
+  ++failures;
+  std::cerr << "FAILED: " << description << "\n";
+}
+
+void checkEqual(const Integer &actual, const Integer &expected,
+                const std::string &description) {
+  check(actual == expected, description + ": got " + actual.toString() +
+                                ", expected " + expected.toString());
+}
+
+Integer ones(size_t bits) { return (Integer(1LL) << bits) - Integer(1LL); }
+
+Integer randomInteger(std::mt19937_64 &random, size_t limbs) {
+  Integer result(1LL);
+  for (size_t index = 0; index < limbs; ++index)
+    result = (result << 64) + Integer(std::to_string(random()));
+  return result - (Integer(1LL) << (64 * limbs));
+}
+
+std::string temporaryPath(const std::string &name) {
+  return (std::filesystem::temp_directory_path() / ("calculator_test_" + name))
+      .string();
+}
+
+std::string readFile(const std::string &path) {
+  std::ifstream input(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(input),
+                     std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string &path, const std::string &contents) {
+  std::ofstream output(path, std::ios::binary | std::ios::trunc);
+  output.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+}
+
+void storeWord(std::string &contents, size_t offset, std::uint64_t word) {
+  for (size_t index = 0; index < 8; ++index)
+    contents[offset + index] = static_cast<char>(word >> (8 * index));
+}
+
+bool throwsRuntimeError(const std::function<void()> &body) {
+  try {
+    body();
+  } catch (const std::runtime_error &) {
+    return true;
+  }
+  return false;
+}
+
+Integer tenTo(size_t exponent) {
+  Integer result(1LL);
+  for (; exponent > 10000; exponent -= 10000)
+    result *= power(Integer(10LL), Integer(10000LL));
+  return result *
+         power(Integer(10LL), Integer(static_cast<long long>(exponent)));
+}
+
+void testSignsAndZero() {
+  Integer zero(0LL);
+  checkEqual(Integer("-0"), zero, "-0 parses as zero");
+  check(Integer("-0").toString() == "0", "-0 prints as 0");
+  check(!(Integer(5LL) * Integer(0LL)).isNegative(), "5 * 0 is not negative");
+  check(!(Integer(-5LL) * Integer(0LL)).isNegative(),
+        "-5 * 0 is not negative");
+  check(!(Integer(7LL) - Integer(7LL)).isNegative(), "7 - 7 is not negative");
+  check((-zero).toString() == "0", "-(0) prints as 0");
+  checkEqual(Integer(-7LL) / Integer(2LL), Integer(-3LL), "-7 / 2");
+  checkEqual(Integer(-7LL) % Integer(2LL), Integer(-1LL), "-7 % 2");
+  checkEqual(Integer(7LL) / Integer(-2LL), Integer(-3LL), "7 / -2");
+  checkEqual(Integer(7LL) % Integer(-2LL), Integer(1LL), "7 % -2");
+  checkEqual(Integer(-7LL) * Integer(-6LL), Integer(42LL), "-7 * -6");
+  checkEqual(Integer(-3LL) + Integer(5LL), Integer(2LL), "-3 + 5");
+  checkEqual(Integer(3LL) + Integer(-5LL), Integer(-2LL), "3 + -5");
+  check(Integer("-18446744073709551617").toString() ==
+            "-18446744073709551617",
+        "negative two-limb round trip");
+  check(Integer(-5LL) < Integer(3LL) && Integer(-5LL) < Integer(-3LL),
+        "ordering across signs");
+  bool threw = false;
+  try {
+    static_cast<void>(Integer(1LL) / zero);
+  } catch (const std::domain_error &) {
+    threw = true;
+  }
+  check(threw, "division by zero throws");
+}
+
+void testCarries() {
+  Integer limb = ones(64);
+  checkEqual(limb + Integer(1LL), Integer("18446744073709551616"),
+             "2^64 - 1 + 1");
+  checkEqual(Integer("18446744073709551616") - Integer(1LL), limb,
+             "2^64 - 1");
+  check((limb * limb).toString() == "340282366920938463426481119284349108225",
+        "(2^64 - 1)^2");
+  for (size_t limbs : {2, 3, 8, 17, 64}) {
+    std::string name = std::to_string(limbs) + " limbs";
+    checkEqual(ones(64 * limbs) + Integer(1LL), Integer(1LL) << (64 * limbs),
+               "carry through " + name);
+    checkEqual((Integer(1LL) << (64 * limbs)) - Integer(1LL),
+               ones(64 * limbs), "borrow through " + name);
+    checkEqual(Integer(-1LL) - ones(64 * limbs),
+               -(Integer(1LL) << (64 * limbs)), "negative carry through " +
+                                                    name);
+  }
+}
+
+void testMultiplicationThresholds() {
+  std::mt19937_64 random(1);
+  const Integer::MultiplicationThresholds defaults =
+      Integer::multiplicationThresholds;
+  for (size_t threshold :
+       {defaults.karatsuba, defaults.toomCook, defaults.numberTheoretic}) {
+    for (size_t limbs : {threshold - 1, threshold, threshold + 1}) {
+      std::string name = std::to_string(limbs) + " limbs";
+      Integer first = ones(64 * limbs), second = ones(64 * (limbs + 1));
+      checkEqual(first * second,
+                 (Integer(1LL) << (64 * (2 * limbs + 1))) -
+                     (Integer(1LL) << (64 * limbs)) -
+                     (Integer(1LL) << (64 * (limbs + 1))) + Integer(1LL),
+                 "all-ones product at " + name);
+      checkEqual(square(first),
+                 (Integer(1LL) << (128 * limbs)) -
+                     (Integer(1LL) << (64 * limbs + 1)) + Integer(1LL),
+                 "all-ones square at " + name);
+
+      Integer left = randomInteger(random, limbs);
+      Integer right = -randomInteger(random, limbs);
+      Integer product = left * right;
+      Integer squared = square(left);
+      Integer::multiplicationThresholds = {size_t(-1), size_t(-1),
+                                           size_t(-1)};
+      checkEqual(product, left * right, "random product at " + name);
+      checkEqual(squared, left * left, "random square at " + name);
+      Integer::multiplicationThresholds = defaults;
+    }
+  }
+}
+
+void testDivisionThreshold() {
+  std::mt19937_64 random(2);
+  size_t threshold = Integer::burnikelZieglerThreshold;
+  for (size_t limbs : {threshold - 1, threshold, threshold + 1,
+                       2 * threshold, 4 * threshold + 3}) {
+    std::string name = std::to_string(limbs) + " limbs";
+    Integer divisor = randomInteger(random, limbs);
+    Integer quotient = randomInteger(random, limbs + 7);
+    Integer remainder = randomInteger(random, limbs) % divisor;
+    Integer dividend = quotient * divisor + remainder;
+    checkEqual(dividend / divisor, quotient, "quotient at " + name);
+    checkEqual(dividend % divisor, remainder, "remainder at " + name);
+    checkEqual(-dividend / divisor, -quotient, "negative quotient at " + name);
+    checkEqual(-dividend % divisor, -remainder,
+               "negative remainder at " + name);
+    checkEqual(ones(128 * limbs) / ones(64 * limbs),
+               (Integer(1LL) << (64 * limbs)) + Integer(1LL),
+               "all-ones quotient at " + name);
+  }
+}
+
+void testRadixConversion() {
+  size_t threshold =
+      Integer::radixConversionThreshold * Integer::decimalChunkDigits;
+  for (size_t digits :
+       {size_t(18), size_t(19), size_t(20), threshold - 1, threshold,
+        threshold + 1, 2 * threshold + 1,
+        (threshold << Integer::tabulatedDecimalLevels) + 1}) {
+    std::string name = std::to_string(digits) + " digits";
+    Integer power = tenTo(digits);
+    check(power.toString() == "1" + std::string(digits, '0'),
+          "10^n prints at " + name);
+    checkEqual(Integer(std::string(digits, '9')), power - Integer(1LL),
+               "all-nines parses at " + name);
+    check((-(power - Integer(1LL))).toString() ==
+              "-" + std::string(digits, '9'),
+          "negative all-nines prints at " + name);
+    std::string leading = "1" + std::string(digits - 1, '0') + "7";
+    check(Integer(leading).toString() == leading,
+          "inner zeros round trip at " + name);
+  }
+}
+
+void testPrimality() {
+  for (const char *composite :
+       {"561", "1105", "1729", "2465", "2821", "6601", "8911", "41041",
+        "2047", "1373653", "25326001", "3215031751", "2152302898747",
+        "3474749660383", "341550071728321", "3825123056546413051",
+        "318665857834031151167461", "3317044064679887385961981",
+        "127111310141580570503753187084858232772715341657404283198329"})
+    check(!isPrime(Integer(composite)),
+          std::string(composite) + " is composite");
+  for (const char *prime :
+       {"2", "3", "5", "1000000007", "18446744073709551557",
+        "340282366920938463463374607431768211297",
+        "170141183460469231731687303715884105727"})
+    check(isPrime(Integer(prime)), std::string(prime) + " is prime");
+  for (size_t exponent : {61, 89, 107, 127, 521, 607, 1279})
+    check(isPrime(ones(exponent)),
+          "2^" + std::to_string(exponent) + " - 1 is prime");
+  for (size_t exponent : {67, 257, 1277})
+    check(!isPrime(ones(exponent)),
+          "2^" + std::to_string(exponent) + " - 1 is composite");
+  check(!isPrime(ones(61) * ones(89)), "product of Mersenne primes");
+  check(!isPrime(Integer(0LL)) && !isPrime(Integer(1LL)) &&
+            !isPrime(Integer(-7LL)),
+        "0, 1 and negatives are not prime");
+}
+
+void testPowerModulo() {
+  Integer base = power(Integer(3LL), Integer(200LL));
+  Integer exponent = (Integer(1LL) << 300) + Integer(12345LL);
+  struct Case {
+    const char *name;
+    Integer modulus;
+    const char *positive;
+    const char *negative;
+  };
+  Case cases[] = {
+      {"odd", ones(521),
+       "5839716636868415033717384103227765843787109804790898493336351993243"
+       "8122071502130496892754466696595927265072568129634990315829623530905"
+       "79912152389721411744598",
+       "1025081023262194681264516695853627373482325495352406916058111465941"
+       "7309762474430024332841939917949622507890545785173590055390256466260"
+       "63900421638569703312553"},
+      {"even", Integer(3LL) << 256,
+       "280813407457152685881322158190226894126378628640440199449623645797"
+       "820079457185",
+       "665628602547959003893907968358368294334313253564814926687491062259"
+       "19309462623"},
+      {"power of two", Integer(1LL) << 200,
+       "682570091961894891028080674707259836600451465322099525731233",
+       "924367952297095384513881417633902765921751528460693309570143"},
+      {"negative", -ones(127), "8825662234387548054687128046314474316",
+       "161315521226081683677000175669569631411"}};
+  for (const Case &test : cases) {
+    checkEqual(powMod(base, exponent, test.modulus), Integer(test.positive),
+               std::string("powMod with ") + test.name + " modulus");
+    checkEqual(powMod(-base, exponent, test.modulus), Integer(test.negative),
+               std::string("powMod of negative base with ") + test.name +
+                   " modulus");
+  }
+  checkEqual(powMod(base, Integer(-1LL), ones(127)),
+             Integer("152345349473335564513052016303910700039"),
+             "powMod with exponent -1");
+  checkEqual(powMod(base, -exponent, ones(127)),
+             Integer("43595777027568798636287267036671161664"),
+             "powMod with negative exponent");
+  checkEqual(powMod(base, Integer(0LL), Integer(1LL)), Integer(0LL),
+             "powMod modulo 1");
+  checkEqual(powMod(Integer(0LL), Integer(0LL), Integer(7LL)), Integer(1LL),
+             "0^0 mod 7");
+
+  size_t threshold = Modulus::montgomeryMultiplicationThreshold;
+  std::mt19937_64 random(3);
+  for (size_t limbs : {threshold - 1, threshold, threshold + 1}) {
+    Integer modulus = randomInteger(random, limbs);
+    if (!modulus.testBit(0))
+      modulus += Integer(1LL);
+    Integer value = randomInteger(random, limbs + 2);
+    Integer small = randomInteger(random, 2);
+    checkEqual(powMod(value, small, modulus),
+               powMod(value, small, modulus * Integer(2LL)) % modulus,
+               "Montgomery against Barrett at " + std::to_string(limbs) +
+                   " limbs");
+  }
+  for (size_t exponent : {9941, 11213})
+    checkEqual(powMod(Integer(3LL), ones(exponent) - Integer(1LL),
+                      ones(exponent)),
+               Integer(1LL),
+               "Fermat test of 2^" + std::to_string(exponent) + " - 1");
+}
+
+void testRoots() {
+  Integer base("12345678901234567");
+  Integer fifth = power(base, Integer(5LL));
+  check(fifth.toString() ==
+            "2867971861733703003909950812011530233410512670831076529848151772"
+            "28070728001997607",
+        "12345678901234567^5");
+  Integer five(5LL);
+  checkEqual(iroot(fifth, five), base, "iroot of exact fifth power");
+  checkEqual(iroot(fifth - Integer(1LL), five), base - Integer(1LL),
+             "iroot below exact fifth power");
+  checkEqual(iroot(fifth + Integer(1LL), five), base,
+             "iroot above exact fifth power");
+  checkEqual(iroot(-fifth, five), -base, "odd root of negative power");
+  check(isPerfectPower(fifth), "exact fifth power is perfect");
+  check(!isPerfectPower(fifth - Integer(1LL)), "fifth power - 1");
+  check(!isPerfectPower(fifth + Integer(1LL)), "fifth power + 1");
+  check(isPerfectPower(-fifth), "negative fifth power is perfect");
+
+  Integer square = power(ones(300), Integer(2LL));
+  checkEqual(isqrt(square), ones(300), "isqrt of exact square");
+  checkEqual(isqrt(square - Integer(1LL)), ones(300) - Integer(1LL),
+             "isqrt below exact square");
+  check(isPerfectPower(square) && !isPerfectPower(square - Integer(1LL)),
+        "perfect square detection");
+  check(!isPerfectPower(-square), "negative square is not a power");
+
+  for (size_t exponent : {61, 64, 128, 4096})
+    check(isPerfectPower(Integer(1LL) << exponent),
+          "2^" + std::to_string(exponent) + " is perfect");
+  check(!isPerfectPower(Integer(2LL)), "2 is not perfect");
+  check(!isPerfectPower(Integer(-2LL)), "-2 is not perfect");
+  check(isPerfectPower(Integer(-8LL)), "-8 is perfect");
+  check(!isPerfectPower(-(Integer(1LL) << 64)), "-2^64 is not perfect");
+  check(isPerfectPower(-(Integer(1LL) << 63)), "-2^63 is perfect");
+  Integer prime("1000000007");
+  Integer seventh = power(prime, Integer(7LL));
+  check(isPerfectPower(seventh) && !isPerfectPower(seventh + Integer(2LL)),
+        "seventh power of a prime");
+  checkEqual(iroot(seventh - Integer(1LL), Integer(7LL)),
+             prime - Integer(1LL), "seventh root just below");
+}
+
+void testKernels() {
+  std::vector<LimbKernels::Table> tables = LimbKernels::available();
+  const LimbKernels::Table &scalar = tables.front();
+  std::mt19937_64 random(4);
+  for (const LimbKernels::Table &table : tables) {
+    std::string name = table.name;
+    for (size_t size = 0; size <= 70; ++size) {
+      for (int pattern = 0; pattern < 4; ++pattern) {
+        std::vector<Integer::Limb> first(size), second(size);
+        for (size_t index = 0; index < size; ++index) {
+          first[index] = pattern == 1 ? ~Integer::Limb(0) : random();
+          second[index] = pattern == 1   ? Integer::Limb(index == 0)
+                          : pattern == 2 ? first[index]
+                          : pattern == 3 ? ~first[index]
+                                         : random();
+        }
+        std::string description =
+            name + " kernels at " + std::to_string(size) + " limbs, pattern " +
+            std::to_string(pattern);
+        std::vector<Integer::Limb> expected(size), actual(size);
+        Integer::Limb carry =
+            scalar.add(expected.data(), first.data(), second.data(), size);
+        check(table.add(actual.data(), first.data(), second.data(), size) ==
+                      carry &&
+                  actual == expected,
+              description + " add");
+        Integer::Limb borrow = scalar.subtract(expected.data(), second.data(),
+                                               first.data(), size);
+        check(table.subtract(actual.data(), second.data(), first.data(),
+                             size) == borrow &&
+                  actual == expected,
+              description + " subtract");
+        check(table.compare(first.data(), second.data(), size) ==
+                  scalar.compare(first.data(), second.data(), size),
+              description + " compare");
+      }
+    }
+  }
+}
+
+void testThreadCountChanges() {
+  std::mt19937_64 random(7);
+  size_t limbs = 4 * Integer::parallelThreshold;
+  Integer first = randomInteger(random, limbs);
+  Integer second = randomInteger(random, limbs);
+  Integer expected = first * second;
+  size_t threads = Integer::threadCount();
+  std::atomic<bool> done{false};
+  std::thread resizer([&] {
+    for (size_t count = 1; !done.load(); count = count % 4 + 1)
+      Integer::setThreadCount(count);
+  });
+  bool matched = true;
+  for (int round = 0; round < 50; ++round)
+    matched = matched && first * second == expected;
+  done = true;
+  resizer.join();
+  Integer::setThreadCount(threads);
+  check(matched, "products while the thread count changes");
+}
+
+void testExpressions() {
+  Expression repeated("007 + 7");
+  check(repeated.nodeCount() == 2, "equal constants share a node");
+  checkEqual(repeated.evaluate(), Integer(14LL), "007 + 7");
+  Expression zeros("0 + 000");
+  check(zeros.nodeCount() == 2, "zero constants share a node");
+  checkEqual(zeros.evaluate(), Integer(0LL), "0 + 000");
+
+  Expression::Variables variables = {{"a", Integer(3LL)},
+                                     {"b", Integer(4LL)}};
+  Expression shared("(a + b) * (b + a)");
+  check(shared.nodeCount() == 4, "commuted sums share a node and square");
+  checkEqual(shared.evaluate(variables), Integer(49LL), "(a + b) * (b + a)");
+  Expression defined("x = a * b; x - x + b * a");
+  check(defined.nodeCount() == 5, "definitions and products share nodes");
+  checkEqual(defined.evaluate(variables), Integer(12LL),
+             "x = a * b; x - x + b * a");
+
+  std::string chain = "x0 = 1";
+  for (int index = 1; index <= 200; ++index)
+    chain += "; x" + std::to_string(index) + " = x" +
+             std::to_string(index - 1) + " + x" + std::to_string(index - 1);
+  Expression doubling(chain + "; x200");
+  check(doubling.nodeCount() == 201, "definition chain lowers once per node");
+  checkEqual(doubling.evaluate(), Integer(1LL) << 200,
+             "definition chain doubles 200 times");
+
+  Expression remainder("(a ^ b) % m");
+  check(remainder.nodeCount() == 4, "(a ^ b) % m lowers to powMod");
+  for (long long base = -5; base <= 5; ++base)
+    for (long long exponent = 0; exponent <= 6; ++exponent)
+      for (long long modulus : {-7, -1, 1, 2, 7, 10}) {
+        Expression::Variables values = {{"a", Integer(base)},
+                                        {"b", Integer(exponent)},
+                                        {"m", Integer(modulus)}};
+        checkEqual(remainder.evaluate(values),
+                   power(Integer(base), Integer(exponent)) % Integer(modulus),
+                   "(" + std::to_string(base) + " ^ " +
+                       std::to_string(exponent) + ") % " +
+                       std::to_string(modulus));
+      }
+  checkEqual(Expression("(2 ^ 100000) % 1000007").evaluate(),
+             Integer(351226LL), "(2 ^ 100000) % 1000007");
+  checkEqual(Expression("(-3) ^ 100001 % 1000003").evaluate(),
+             Integer(-397291LL), "(-3) ^ 100001 % 1000003");
+  checkEqual(Expression("(-3) ^ 100000 % 1000003").evaluate(),
+             powMod(Integer(3LL), Integer(100000LL), Integer(1000003LL)),
+             "(-3) ^ 100000 % 1000003");
+}
+
+void testIntegerFiles() {
+  std::mt19937_64 random(5);
+  std::string path = temporaryPath("integer.int");
+  std::string copy = temporaryPath("corrupt.int");
+  std::vector<Integer> values = {Integer(0LL), Integer(-1LL),
+                                 Integer(1LL) << 64, -randomInteger(random, 10),
+                                 randomInteger(random, 511),
+                                 randomInteger(random, 512),
+                                 -randomInteger(random, 2000)};
+  for (const Integer &value : values) {
+    std::string name = std::to_string(value.bitLength()) + "-bit file";
+    value.save(path);
+    Integer loaded = Integer::load(path);
+    checkEqual(loaded, value, "round trip of " + name);
+    loaded += Integer(1LL);
+    checkEqual(loaded, value + Integer(1LL), "arithmetic on loaded " + name);
+    checkEqual(Integer::load(path), value, "file unchanged for " + name);
+  }
+
+  for (size_t limbs : {10, 600}) {
+    std::string name = std::to_string(limbs) + "-limb file";
+    randomInteger(random, limbs).save(path);
+    std::string contents = readFile(path);
+
+    std::string corrupt = contents;
+    corrupt[0] = 'X';
+    writeFile(copy, corrupt);
+    check(throwsRuntimeError([&] { Integer::load(copy); }),
+          "bad magic rejected in " + name);
+
+    corrupt = contents;
+    storeWord(corrupt, 8, 2);
+    writeFile(copy, corrupt);
+    check(throwsRuntimeError([&] { Integer::load(copy); }),
+          "wrong version rejected in " + name);
+
+    for (size_t length : {size_t(0), size_t(20), contents.size() - 1}) {
+      writeFile(copy, contents.substr(0, length));
+      check(throwsRuntimeError([&] { Integer::load(copy); }),
+            "truncation to " + std::to_string(length) + " bytes rejected in " +
+                name);
+    }
+
+    for (std::uint64_t size :
+         {std::uint64_t(limbs + 1), std::uint64_t(1) << 61,
+          ~std::uint64_t(0)}) {
+      corrupt = contents;
+      storeWord(corrupt, 16, size);
+      writeFile(copy, corrupt);
+      check(throwsRuntimeError([&] { Integer::load(copy); }),
+            "limb count " + std::to_string(size) + " rejected in " + name);
+    }
+  }
+  check(throwsRuntimeError([&] { Integer::load(temporaryPath("missing")); }),
+        "missing file rejected");
+  std::filesystem::remove(path);
+  std::filesystem::remove(copy);
+}
+
+void testResultCacheFiles() {
+  std::mt19937_64 random(6);
+  std::string path = temporaryPath("results.cache");
+  std::string copy = temporaryPath("corrupt.cache");
+  ResultCache::Clock::duration minimumCost = ResultCache::minimumCost;
+  ResultCache::minimumCost = ResultCache::Clock::duration::zero();
+
+  Integer small(1000LL), base = randomInteger(random, 600);
+  Integer exponent = -randomInteger(random, 3), modulus = Integer(1LL) << 700;
+  ResultCache cache(size_t(64) << 20);
+  Integer smallFactorial = cache.get(
+      Operation::Factorial, [&] { return factorial(small); }, small);
+  Integer residue = cache.get(
+      Operation::PowerModulo,
+      [&] { return base * exponent % modulus; }, base, exponent, modulus);
+  check(cache.save(path), "cache saved");
+
+  ResultCache loaded(size_t(64) << 20);
+  check(loaded.load(path), "cache loaded");
+  check(loaded.statistics().entries == 2, "cache entries restored");
+  bool computed = false;
+  auto recompute = [&] {
+    computed = true;
+    return Integer();
+  };
+  checkEqual(loaded.get(Operation::Factorial, recompute, small),
+             smallFactorial, "cached factorial restored");
+  checkEqual(loaded.get(Operation::PowerModulo, recompute, base, exponent,
+                        modulus),
+             residue, "cached negative operands restored");
+  check(!computed && loaded.statistics().hits == 2,
+        "restored entries are hits");
+
+  std::string contents = readFile(path);
+  std::vector<std::pair<std::string, std::string>> corrupt;
+  corrupt.emplace_back("bad magic", "X" + contents.substr(1));
+  corrupt.emplace_back("wrong version", contents);
+  storeWord(corrupt.back().second, 16, 2);
+  corrupt.emplace_back("bad operation", contents);
+  corrupt.back().second[24] = static_cast<char>(Operation::Count);
+  for (std::uint64_t size :
+       {std::uint64_t(contents.size()), std::uint64_t(1) << 62}) {
+    corrupt.emplace_back("limb count " + std::to_string(size), contents);
+    storeWord(corrupt.back().second, 26, size << 1);
+  }
+  for (size_t length : {size_t(4), size_t(25), size_t(30),
+                        contents.size() - 1})
+    corrupt.emplace_back("truncation to " + std::to_string(length),
+                         contents.substr(0, length));
+  for (const auto &[name, bytes] : corrupt) {
+    writeFile(copy, bytes);
+    ResultCache rejected(size_t(64) << 20);
+    check(throwsRuntimeError([&] { rejected.load(copy); }) &&
+              rejected.statistics().entries == 0,
+          "cache with " + name + " rejected");
+  }
+  ResultCache missing(size_t(64) << 20);
+  check(!missing.load(temporaryPath("missing")), "missing cache ignored");
+
+  ResultCache::minimumCost = minimumCost;
+  std::filesystem::remove(path);
+  std::filesystem::remove(copy);
+}
+
+} // namespace
+
+int main() {
+  std::cout << "Kernels: " << LimbKernels::implementation() << "\n";
+  testSignsAndZero();
+  testCarries();
+  testMultiplicationThresholds();
+  testDivisionThreshold();
+  testRadixConversion();
+  testPrimality();
+  testPowerModulo();
+  testRoots();
+  testKernels();
+  testThreadCountChanges();
+  testExpressions();
+  testIntegerFiles();
+  testResultCacheFiles();
+  if (failures) {
+    std::cerr << failures << " checks failed\n";
+    return 1;
+  }
+  std::cout << "All checks passed\n";
+  return 0;
+}